@@ -23,14 +23,41 @@
                 "src/File.cpp",
                 "src/Attribute.cpp",
                 "src/Group.cpp",
-                "src/Variable.cpp"
-                
+                "src/Variable.cpp",
+                "src/SharedMemory.cpp",
+                "src/BufferPool.cpp",
+                "src/Coalescer.cpp",
+                "src/ResultCache.cpp",
+                "src/Schema.cpp",
+                "src/Scanner.cpp",
+                "src/MetadataIndex.cpp",
+                "src/HandlePool.cpp",
+                "src/ClassicReader.cpp",
+                "src/ChunkEngine.cpp",
+                "src/Decimator.cpp",
+                "src/AdaptiveCache.cpp"
+
             ],
             "target_name": "netcdf4-async",
+            "variables": {
+                # Chunk engine reads HDF5 chunks directly, it is built when HDF5 and zlib are found
+                "direct_chunks%": "<!(pkg-config --exists hdf5 zlib && echo 1 || echo 0)"
+            },
             "include_dirs": ["<!@(node -p \"require('node-addon-api').include\")"],
             "target_name": "netcdf4-async",
             'defines': ['NAPI_CPP_EXCEPTIONS'],
             "conditions": [
+                ['OS!="win" and direct_chunks==1', {
+                    'defines': ['NETCDF4_DIRECT_CHUNKS'],
+                    'cflags_cc': ['<!@(pkg-config --cflags hdf5 zlib)'],
+                    'libraries': ['<!@(pkg-config --libs hdf5 zlib)'],
+                    'xcode_settings': {
+                        'OTHER_CPLUSPLUSFLAGS': ['<!@(pkg-config --cflags hdf5 zlib)']
+                    }
+                }],
+                ['OS=="linux"', {
+                    "libraries": ["-lrt"]
+                }],
                 ['OS=="mac"', {
                     'cflags+': ['-fvisibility=hidden','-std=c++14'],
                     'xcode_settings': {
@@ -1 +1,8 @@
-module.exports = require("./build/Release/netcdf4-async.node");
+const netcdf4 = require("./build/Release/netcdf4-async.node");
+const { ReaderPool } = require("./lib/pool");
+const { scan } = require("./lib/scan");
+
+netcdf4.ReaderPool = ReaderPool;
+netcdf4.scan = scan;
+
+module.exports = netcdf4;
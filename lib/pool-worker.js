@@ -0,0 +1,81 @@
+// Helper process of ReaderPool. Keeps files open and reads variables into shared memory
+const native = require("../build/Release/netcdf4-async.node");
+const { arrayTypes } = require("./pool");
+
+const files = new Map();
+const variables = new Map();
+const segments = new Map();
+
+const openFile = path => {
+  let file = files.get(path);
+  if (file === undefined) {
+    file = native.open(path, "r");
+    files.set(path, file);
+    file.catch(() => files.delete(path));
+  }
+  return file;
+};
+
+const getVariable = (path, name) => {
+  const key = `${path}\0${name}`;
+  let variable = variables.get(key);
+  if (variable === undefined) {
+    variable = (async () => {
+      const file = await openFile(path);
+      const parts = name.split("/").filter(part => part.length > 0);
+      let group = file.root;
+      for (const part of parts.slice(0, -1)) {
+        group = await group.getSubgroup(part);
+      }
+      return group.getVariable(parts[parts.length - 1]);
+    })();
+    variables.set(key, variable);
+    variable.catch(() => variables.delete(key));
+  }
+  return variable;
+};
+
+const read = async ({ path, variable: name, start, count, segment: segmentName }) => {
+  const variable = await getVariable(path, name);
+  const Type = arrayTypes[variable.type];
+  if (Type === undefined) {
+    throw new Error(`NetCDF4: Variable type ${variable.type} not supported by reader pool`);
+  }
+  const length = count.reduce((a, b) => a * b, 1);
+  const segment = native.createShared(length * Type.BYTES_PER_ELEMENT, segmentName);
+  segments.set(segment.name, segment.buffer);
+  const args = [];
+  start.forEach((s, i) => args.push(s, count[i]));
+  try {
+    await variable.readSliceInto(new Type(segment.buffer), 0, ...args);
+  } catch (e) {
+    // Parent never gets name of failed segment, so it is removed here
+    native.unlinkShared(segment.name);
+    segments.delete(segment.name);
+    throw e;
+  }
+  return { name: segment.name, type: variable.type, length };
+};
+
+process.on("message", async message => {
+  switch (message.op) {
+    case "read":
+      try {
+        process.send(Object.assign({ id: message.id }, await read(message)));
+      } catch (e) {
+        process.send({ id: message.id, error: e.message || String(e) });
+      }
+      break;
+    case "release":
+      // Parent mapped segment, drop our mapping
+      segments.delete(message.name);
+      break;
+    case "exit":
+      for (const file of files.values()) {
+        try {
+          await (await file).close();
+        } catch (e) {}
+      }
+      process.exit(0);
+  }
+});
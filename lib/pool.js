@@ -0,0 +1,162 @@
+const { fork } = require("child_process");
+const { cpus } = require("os");
+const { join } = require("path");
+const native = require("../build/Release/netcdf4-async.node");
+
+const arrayTypes = {
+  byte: Int8Array,
+  short: Int16Array,
+  int: Int32Array,
+  float: Float32Array,
+  double: Float64Array,
+  ubyte: Uint8Array,
+  ushort: Uint16Array,
+  uint: Uint32Array
+};
+if (typeof BigInt64Array !== "undefined") {
+  arrayTypes.int64 = BigInt64Array;
+  arrayTypes.uint64 = BigUint64Array;
+}
+
+// Segments are named by pool, so names of segments left by crashed helper are known
+const segmentPrefix = process.platform === "win32" ? "Local\\nc4a." : "/nc4a.";
+let pools = 0;
+
+/**
+ * Pool of helper processes, each with its own libnetcdf instance.
+ * libnetcdf is not thread safe, so reads (and chunk decompression) inside one process
+ * are serialized. Pool spreads reads over several processes; data is returned through
+ * shared memory segment, which is wrapped into TypedArray without copying.
+ */
+class ReaderPool {
+  /**
+   * @param {Object} options
+   * @param {number} options.processes Number of helper processes (number of CPUs by default)
+   */
+  constructor(options = {}) {
+    this.size = options.processes || cpus().length;
+    if (!Number.isInteger(this.size) || this.size < 1) {
+      throw new TypeError("processes must be a positive integer");
+    }
+    this.workers = [];
+    this.next = 0;
+    this.lastId = 0;
+    this.closed = false;
+    this.segmentPrefix = `${segmentPrefix}${process.pid}.${++pools}.`;
+  }
+
+  _spawn() {
+    const worker = {
+      process: fork(join(__dirname, "pool-worker.js"), [], { stdio: "inherit" }),
+      pending: new Map()
+    };
+    worker.process.on("message", message => this._onMessage(worker, message));
+    worker.process.on("exit", code => {
+      this.workers = this.workers.filter(w => w !== worker);
+      for (const { reject, segment } of worker.pending.values()) {
+        // Helper may have created segment before it exited
+        if (segment !== undefined) {
+          native.unlinkShared(segment);
+        }
+        reject(new Error(`NetCDF4: Reader process exited with code ${code}`));
+      }
+      worker.pending.clear();
+    });
+    this.workers.push(worker);
+    return worker;
+  }
+
+  _onMessage(worker, message) {
+    const request = worker.pending.get(message.id);
+    if (!request) {
+      return;
+    }
+    worker.pending.delete(message.id);
+    if (message.error !== undefined) {
+      request.reject(new Error(message.error));
+      return;
+    }
+    if (message.name === undefined) {
+      request.resolve(message.result);
+      return;
+    }
+    try {
+      const Type = arrayTypes[message.type];
+      const buffer = native.attachShared(
+        message.name,
+        message.length * Type.BYTES_PER_ELEMENT,
+        true
+      );
+      request.resolve(new Type(buffer));
+    } catch (e) {
+      // Segment was not attached, so its name is still there
+      native.unlinkShared(message.name);
+      request.reject(e);
+    } finally {
+      worker.process.send({ op: "release", name: message.name });
+    }
+  }
+
+  /**
+   * Pick least loaded process, spawning new ones until pool is full
+   */
+  _pick() {
+    let best = null;
+    for (let i = 0; i < this.workers.length; i++) {
+      const worker = this.workers[(this.next + i) % this.workers.length];
+      if (best === null || worker.pending.size < best.pending.size) {
+        best = worker;
+      }
+    }
+    this.next++;
+    if (this.workers.length < this.size && (best === null || best.pending.size > 0)) {
+      return this._spawn();
+    }
+    return best;
+  }
+
+  _request(message) {
+    if (this.closed) {
+      return Promise.reject(new Error("NetCDF4: Reader pool closed"));
+    }
+    const worker = this._pick();
+    const id = ++this.lastId;
+    const segment = message.op === "read" ? `${this.segmentPrefix}${id}` : undefined;
+    return new Promise((resolve, reject) => {
+      worker.pending.set(id, { resolve, reject, segment });
+      worker.process.send(Object.assign({ id, segment }, message));
+    });
+  }
+
+  /**
+   * Read hyperslab of variable
+   * @param {string} path File path
+   * @param {string} variable Variable full name, i.e. "/group/subgroup/variable"
+   * @param {number[]} start Start position for each dimension
+   * @param {number[]} count Number of values for each dimension
+   * @returns {Promise<TypedArray>}
+   */
+  readSlice(path, variable, start, count) {
+    return this._request({ op: "read", path, variable, start, count });
+  }
+
+  /**
+   * Stop all helper processes
+   */
+  async close() {
+    this.closed = true;
+    const workers = this.workers;
+    this.workers = [];
+    await Promise.all(
+      workers.map(
+        worker =>
+          new Promise(resolve => {
+            worker.process.once("exit", resolve);
+            worker.process.send({ op: "exit" });
+          })
+      )
+    );
+  }
+}
+
+module.exports = { ReaderPool, arrayTypes };
@@ -0,0 +1,87 @@
+const native = require("../build/Release/netcdf4-async.node");
+
+/**
+ * Split paths into batches. Accepts array or any (async) iterable
+ * @param {Iterable<string>|AsyncIterable<string>} paths
+ * @param {number} batchSize
+ */
+async function* batches(paths, batchSize) {
+  let batch = [];
+  for await (const path of paths) {
+    batch.push(String(path));
+    if (batch.length === batchSize) {
+      yield batch;
+      batch = [];
+    }
+  }
+  if (batch.length > 0) {
+    yield batch;
+  }
+}
+
+/**
+ * Summarize many files. Each batch of paths is opened, summarized and closed by one native worker,
+ * which holds netcdf lock for one file at a time, so opened files are not blocked by scan.
+ * Files which can't be opened are reported as `{path, error}` and do not stop scan.
+ * @param {Iterable<string>|AsyncIterable<string>} paths File paths
+ * @param {Object} options
+ * @param {number} options.concurrency Number of batches in progress (`ioThreads` by default)
+ * @param {number} options.batchSize Number of files summarized by one native call (64 by default)
+ * @param {string[]} options.fields Sections of root group in summary, as in `describe()`
+ * @param {boolean} options.sniff Detect format by magic bytes only, without opening files
+ * @returns {AsyncGenerator<Object>} Summaries, in order of paths within batch, in order of completion across batches
+ */
+async function* scan(paths, options = {}) {
+  const concurrency =
+    options.concurrency === undefined ? native.configure().ioThreads : options.concurrency;
+  const batchSize = options.batchSize === undefined ? 64 : options.batchSize;
+  if (!Number.isInteger(concurrency) || concurrency < 1) {
+    throw new TypeError("concurrency must be a positive integer");
+  }
+  if (!Number.isInteger(batchSize) || batchSize < 1) {
+    throw new TypeError("batchSize must be a positive integer");
+  }
+  const batchOptions = { sniff: !!options.sniff };
+  if (options.fields !== undefined) {
+    batchOptions.fields = options.fields;
+  }
+  const inFlight = new Map();
+  let lastId = 0;
+  const start = batch => {
+    const id = ++lastId;
+    inFlight.set(
+      id,
+      native.scanBatch(batch, batchOptions).then(
+        summaries => ({ id, summaries }),
+        error => ({ id, error })
+      )
+    );
+  };
+  const source = batches(paths, batchSize);
+  let exhausted = false;
+  try {
+    while (true) {
+      while (!exhausted && inFlight.size < concurrency) {
+        const next = await source.next();
+        if (next.done) {
+          exhausted = true;
+        } else {
+          start(next.value);
+        }
+      }
+      if (inFlight.size === 0) {
+        return;
+      }
+      const { id, summaries, error } = await Promise.race(inFlight.values());
+      inFlight.delete(id);
+      if (error !== undefined) {
+        throw typeof error === "string" ? new Error(error) : error;
+      }
+      yield* summaries;
+    }
+  } finally {
+    await source.return();
+  }
+}
+
+module.exports = { scan };
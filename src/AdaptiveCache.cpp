@@ -0,0 +1,78 @@
+#include <netcdf.h>
+#include "netcdf4-async.h"
+#include "async.h"
+#include "AdaptiveCache.h"
+
+namespace netcdf4async {
+
+    /**
+     * @brief Registry instance
+     * Registry is never destroyed, as other process-wide singletons
+     * @return AdaptiveCacheRegistry&
+     */
+    AdaptiveCacheRegistry &AdaptiveCacheRegistry::Instance() {
+        static AdaptiveCacheRegistry *registry=new AdaptiveCacheRegistry();
+        return *registry;
+    }
+
+    AdaptiveCache AdaptiveCacheRegistry::Enable(int ncid, int varid, int ndims, size_t max_size) {
+        AdaptiveCache state;
+        state.max_size=max_size;
+        state.observed.assign(static_cast<size_t>(ndims), 0);
+        std::lock_guard<std::mutex> guard(lock);
+        files[NC_FILE_ID(ncid)][std::make_pair(ncid, varid)]=state;
+        return state;
+    }
+
+    void AdaptiveCacheRegistry::Disable(int ncid, int varid) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=files.find(NC_FILE_ID(ncid));
+        if (it == files.end()) {
+            return;
+        }
+        it->second.erase(std::make_pair(ncid, varid));
+        if (it->second.empty()) {
+            files.erase(it);
+        }
+    }
+
+    bool AdaptiveCacheRegistry::Enabled(int ncid, int varid) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=files.find(NC_FILE_ID(ncid));
+        return it != files.end() && it->second.count(std::make_pair(ncid, varid)) > 0;
+    }
+
+    bool AdaptiveCacheRegistry::Observe(int ncid, int varid, const Hyperslab &slab, AdaptiveCache &state) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto file=files.find(NC_FILE_ID(ncid));
+        if (file == files.end()) {
+            return false;
+        }
+        auto it=file->second.find(std::make_pair(ncid, varid));
+        if (it == file->second.end()) {
+            return false;
+        }
+        std::vector<size_t> &observed=it->second.observed;
+        bool grown=false;
+        for (size_t i = 0; i < slab.count.size() && i < observed.size(); i++) {
+            size_t extent=slab.count[i];
+            if (extent > 0 && !slab.stride.empty()) {
+                extent=(extent - 1) * static_cast<size_t>(slab.stride[i]) + 1;
+            }
+            if (extent > observed[i]) {
+                observed[i]=extent;
+                grown=true;
+            }
+        }
+        if (grown) {
+            state=it->second;
+        }
+        return grown;
+    }
+
+    void AdaptiveCacheRegistry::Remove(int id) {
+        std::lock_guard<std::mutex> guard(lock);
+        files.erase(NC_FILE_ID(id));
+    }
+
+}
@@ -0,0 +1,63 @@
+#ifndef NETCDF4_ADAPTIVECACHE_H
+#define NETCDF4_ADAPTIVECACHE_H
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "Macros.h"
+
+namespace netcdf4async {
+
+    /// @brief Adaptive chunk cache state of variable
+    struct AdaptiveCache {
+        /// @brief Max chunk cache size
+        size_t max_size;
+        /// @brief Largest extent of read hyperslabs along each dimension
+        std::vector<size_t> observed;
+    };
+
+    /**
+     * @brief Process-wide registry of variables with adaptive chunk cache
+     * State is kept by file, group and variable id, so it is shared by all Variable objects
+     * of the same variable, e.g. built by group.variables or getVariable.
+     */
+    class AdaptiveCacheRegistry {
+        public:
+            /// @brief Registry instance
+            /// @return registry
+            static AdaptiveCacheRegistry &Instance();
+            /// @brief Size chunk cache of variable by observed reads from now on
+            /// @param ncid NetCDF group id
+            /// @param varid Variable id
+            /// @param ndims Number of dimensions
+            /// @param max_size Max chunk cache size
+            /// @return State to apply at once
+            AdaptiveCache Enable(int ncid, int varid, int ndims, size_t max_size);
+            /// @brief Stop sizing chunk cache of variable
+            /// @param ncid NetCDF group id
+            /// @param varid Variable id
+            void Disable(int ncid, int varid);
+            /// @brief Is chunk cache of variable sized by observed reads
+            /// @param ncid NetCDF group id
+            /// @param varid Variable id
+            bool Enabled(int ncid, int varid);
+            /// @brief Account read hyperslab
+            /// @param ncid NetCDF group id
+            /// @param varid Variable id
+            /// @param slab Read hyperslab
+            /// @param state Set to new state if cache should grow
+            /// @return true if read is larger than observed before along some dimension
+            bool Observe(int ncid, int varid, const Hyperslab &slab, AdaptiveCache &state);
+            /// @brief Forget variables of closed file
+            /// @param id NetCDF file id
+            void Remove(int id);
+        private:
+            AdaptiveCacheRegistry() {};
+            std::mutex lock;
+            std::map<int, std::map<std::pair<int, int>, AdaptiveCache>> files;
+    };
+
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include "utils.h"
 #include <node_version.h>
 #include "Macros.h"
+#include "Schema.h"
 
 namespace netcdf4async {
 
@@ -74,7 +75,7 @@ Napi::Value attr2value(Napi::Env env, Item *nc_item) {
 }
 
 
-Napi::Value get_attributes(Napi::Env env, int parent_id, int var_id, bool return_type) {
+Napi::Value get_attributes(Napi::Env env, int parent_id, int var_id, bool return_type, const FileToken &token) {
     auto worker = new NCAsyncWorker<NCAttribute_list>(
 		env,
 		[parent_id, var_id] (const NCAsyncWorker<NCAttribute_list>* worker) {
@@ -101,35 +102,35 @@ Napi::Value get_attributes(Napi::Env env, int parent_id, int var_id, bool return
 				
 				switch (type) {
 				case NC_BYTE: 
-					attribute.value.i8 = new int8_t[len];
+					TYPED_VALUE(attribute.value,int8_t,len)
 				break;
 				case NC_SHORT: 
-					attribute.value.i16 = new int16_t[len];
+					TYPED_VALUE(attribute.value,int16_t,len)
 				break;
 				case NC_INT: 
-					attribute.value.i32 = new int32_t[len];
+					TYPED_VALUE(attribute.value,int32_t,len)
 				break;
 				case NC_FLOAT: 
-					attribute.value.f = new float[len];
+					TYPED_VALUE(attribute.value,float,len)
 				break;
 				case NC_DOUBLE:
-					attribute.value.d = new double[len];
+					TYPED_VALUE(attribute.value,double,len)
 				break;
 				case NC_UBYTE: 
-					attribute.value.u8 = new uint8_t[len];
+					TYPED_VALUE(attribute.value,uint8_t,len)
 				break;
 				case NC_USHORT: 
-					attribute.value.u16 = new uint16_t[len];
+					TYPED_VALUE(attribute.value,uint16_t,len)
 				break;
 				case NC_UINT: 
-					attribute.value.u32 = new uint32_t[len];
+					TYPED_VALUE(attribute.value,uint32_t,len)
 				break;
 #if NODE_MAJOR_VERSION > 8
 				case NC_UINT64: 
-					attribute.value.u64 = new uint64_t[len];
+					TYPED_VALUE(attribute.value,uint64_t,len)
 				break;
 				case NC_INT64:
-					attribute.value.i64 = new int64_t[len];
+					TYPED_VALUE(attribute.value,int64_t,len)
 				break;
 #endif
 				case NC_CHAR: 
@@ -168,13 +169,13 @@ Napi::Value get_attributes(Napi::Env env, int parent_id, int var_id, bool return
 			return attributes;
 		}
 	);
-	worker->Queue();
+	worker->Queue(parent_id, token);
 
     return worker->Deferred().Promise();
 }
 
 Napi::Value add_attribute(Napi::Env env, Napi::Promise::Deferred deferred, int parent_id, int var_id,
-    const std::string attribute_name, int type, const Napi::Value &value) {
+    const std::string attribute_name, int type, const Napi::Value &value, const FileToken &token) {
 		Item nc_item;
 		nc_item.name = attribute_name;
 		nc_item.type = type;
@@ -257,6 +258,7 @@ Napi::Value add_attribute(Napi::Env env, Napi::Promise::Deferred deferred, int p
 				NC_CALL(nc_put_att(parent_id, var_id,nc_item.name.c_str(), nc_item.type, nc_item.len, nc_item.value.v));
 				
 			}
+			SchemaRegistry::Instance().RefreshVariable(parent_id, var_id);
 			return nc_item;
 		},
 		[] (Napi::Env env, Item result) {
@@ -270,18 +272,19 @@ Napi::Value add_attribute(Napi::Env env, Napi::Promise::Deferred deferred, int p
 			return attribute;
 		}
 	);
-	worker->Queue();
+	worker->Queue(parent_id, token);
 	return worker->Deferred().Promise();
 }
 
-Napi::Value rename_attribute(Napi::Env env, Napi::Promise::Deferred deferred, int parent_id, int var_id, const std::string old_name, const std::string new_name) {
+Napi::Value rename_attribute(Napi::Env env, Napi::Promise::Deferred deferred, int parent_id, int var_id, const std::string old_name, const std::string new_name, const FileToken &token) {
 
 	auto worker = new NCAsyncWorker<std::string>(
 		env,
 		[parent_id, var_id, old_name, new_name] (const NCAsyncWorker<std::string>* worker) {
 			
 			NC_CALL(nc_rename_att(parent_id, var_id, old_name.c_str(), new_name.c_str()));
-			
+			SchemaRegistry::Instance().RefreshVariable(parent_id, var_id);
+
             return new_name;
 		},
 		[] (Napi::Env env, std::string result) {
@@ -289,18 +292,19 @@ Napi::Value rename_attribute(Napi::Env env, Napi::Promise::Deferred deferred, in
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(parent_id, token);
 	return worker->Deferred().Promise();
 }
 
 Napi::Value delete_attribute(Napi::Env env, Napi::Promise::Deferred deferred,
- int parent_id, int var_id, const std::string name) {
+ int parent_id, int var_id, const std::string name, const FileToken &token) {
 	auto worker = new NCAsyncWorker<std::string>(
 		env,
 		[parent_id, var_id, name] (const NCAsyncWorker<std::string>* worker) {
 			
 			NC_CALL(nc_del_att(parent_id, var_id, name.c_str()));
-			
+			SchemaRegistry::Instance().RefreshVariable(parent_id, var_id);
+
             return name;
 		},
 		[] (Napi::Env env, std::string result) {
@@ -308,7 +312,7 @@ Napi::Value delete_attribute(Napi::Env env, Napi::Promise::Deferred deferred,
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(parent_id, token);
 	return worker->Deferred().Promise();
  }
 
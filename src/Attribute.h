@@ -4,17 +4,18 @@
 #include <napi.h>
 #include <string>
 #include <node_version.h>
+#include "async.h"
 
 namespace netcdf4async {
 
 
 Napi::Value add_attribute(Napi::Env env, Napi::Promise::Deferred deferred, int parent_id, int var_id,
-    const std::string attribute_name, int type, const Napi::Value &value);
-Napi::Value get_attributes(Napi::Env env, int parent_id, int var_id, bool return_type);
+    const std::string attribute_name, int type, const Napi::Value &value, const FileToken &token);
+Napi::Value get_attributes(Napi::Env env, int parent_id, int var_id, bool return_type, const FileToken &token);
 Napi::Value rename_attribute(Napi::Env env, Napi::Promise::Deferred deferred, int parent_id,
-    int var_id, const std::string old_name, const std::string new_name);
+    int var_id, const std::string old_name, const std::string new_name, const FileToken &token);
 Napi::Value delete_attribute(Napi::Env env, Napi::Promise::Deferred deferred,
- int parent_id, int var_id, const std::string name);
+ int parent_id, int var_id, const std::string name, const FileToken &token);
 
 }
 
@@ -0,0 +1,122 @@
+#include <new>
+#include "BufferPool.h"
+
+namespace netcdf4async {
+
+    /// @brief Block header keeping size class, padded to keep data aligned
+    union BlockHeader {
+        size_t size;
+        std::max_align_t align;
+    };
+
+    /// @brief Smallest size class
+    const size_t min_class_size=64;
+
+    BufferPool::BufferPool() : capacity(default_buffer_pool_size), cached(0), hits(0), misses(0) {
+    }
+
+    /**
+     * @brief Pool instance
+     * Pool is never destroyed: ArrayBuffer finalizers may return buffers during process exit
+     * @return BufferPool&
+     */
+    BufferPool &BufferPool::Instance() {
+        static BufferPool *pool=new BufferPool();
+        return *pool;
+    }
+
+    /**
+     * @brief Round size up to its size class
+     * Classes are min_class_size and then four classes per power of two,
+     * so at most 25% of block is unused
+     * @param bytes requested size
+     * @return size_t class size
+     */
+    size_t BufferPool::ClassSize(size_t bytes) {
+        if (bytes <= min_class_size) {
+            return min_class_size;
+        }
+        size_t octave=min_class_size;
+        while (octave * 2 < bytes) {
+            octave *= 2;
+        }
+        size_t step=octave / 4;
+        return (bytes + step - 1) / step * step;
+    }
+
+    void *BufferPool::Acquire(size_t bytes) {
+        size_t size=ClassSize(bytes);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto it=kept.find(size);
+            if (it != kept.end() && !it->second.empty()) {
+                void *data=it->second.back();
+                it->second.pop_back();
+                cached -= size;
+                hits++;
+                return data;
+            }
+            misses++;
+        }
+        BlockHeader *block=static_cast<BlockHeader *>(::operator new(sizeof(BlockHeader) + size));
+        block->size=size;
+        return block + 1;
+    }
+
+    void BufferPool::Release(void *data) {
+        if (data == nullptr) {
+            return;
+        }
+        BlockHeader *block=static_cast<BlockHeader *>(data) - 1;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (cached + block->size <= capacity) {
+                kept[block->size].push_back(data);
+                cached += block->size;
+                return;
+            }
+        }
+        ::operator delete(block);
+    }
+
+    /**
+     * @brief Free kept buffers above capacity, largest first
+     * Must be called with lock held
+     */
+    void BufferPool::Trim() {
+        for (auto it=kept.rbegin(); it != kept.rend() && cached > capacity; ++it) {
+            while (!it->second.empty() && cached > capacity) {
+                ::operator delete(static_cast<BlockHeader *>(it->second.back()) - 1);
+                it->second.pop_back();
+                cached -= it->first;
+            }
+        }
+    }
+
+    void BufferPool::Resize(size_t bytes) {
+        std::lock_guard<std::mutex> guard(lock);
+        capacity=bytes;
+        Trim();
+    }
+
+    size_t BufferPool::Capacity() {
+        std::lock_guard<std::mutex> guard(lock);
+        return capacity;
+    }
+
+    size_t BufferPool::Cached() {
+        std::lock_guard<std::mutex> guard(lock);
+        return cached;
+    }
+
+    uint64_t BufferPool::Hits() {
+        std::lock_guard<std::mutex> guard(lock);
+        return hits;
+    }
+
+    uint64_t BufferPool::Misses() {
+        std::lock_guard<std::mutex> guard(lock);
+        return misses;
+    }
+
+}
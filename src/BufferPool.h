@@ -0,0 +1,64 @@
+#ifndef NETCDF4_BUFFERPOOL_H
+#define NETCDF4_BUFFERPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace netcdf4async {
+
+    /**
+     * @brief Process-wide pool of read buffers
+     * Buffers are grouped into size classes (four classes per power of two), released buffers
+     * are kept for reuse while total size of kept buffers is below pool capacity.
+     * Buffers handed to ArrayBuffer come back when JS garbage-collects the result.
+     */
+    class BufferPool {
+        public:
+            /// @brief Pool instance
+            /// @return pool
+            static BufferPool &Instance();
+            /// @brief Get buffer of at least given size, reused one if possible
+            /// @param bytes Size in bytes
+            /// @return buffer, aligned for any numeric type
+            void *Acquire(size_t bytes);
+            /// @brief Return buffer to pool, or free it if pool is full
+            /// @param data Buffer got from Acquire, nullptr is ignored
+            void Release(void *data);
+            /// @brief Typed Acquire
+            /// @param len Number of elements
+            /// @return buffer
+            template <typename T> T *Allocate(size_t len) {
+                return static_cast<T *>(Acquire(len * sizeof(T)));
+            }
+            /// @brief Change pool capacity, extra kept buffers are freed
+            /// @param bytes New capacity in bytes, 0 disables pooling
+            void Resize(size_t bytes);
+            /// @brief Pool capacity in bytes
+            size_t Capacity();
+            /// @brief Size of kept buffers in bytes
+            size_t Cached();
+            /// @brief Number of Acquire calls served by kept buffer
+            uint64_t Hits();
+            /// @brief Number of Acquire calls served by new allocation
+            uint64_t Misses();
+        private:
+            BufferPool();
+            static size_t ClassSize(size_t bytes);
+            void Trim();
+            std::mutex lock;
+            std::map<size_t, std::vector<void *>> kept;
+            size_t capacity;
+            size_t cached;
+            uint64_t hits;
+            uint64_t misses;
+    };
+
+    /// @brief Default capacity of buffer pool
+    const size_t default_buffer_pool_size=64*1024*1024;
+
+}
+
+#endif
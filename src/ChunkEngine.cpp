@@ -0,0 +1,727 @@
+#include <netcdf.h>
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef NETCDF4_DIRECT_CHUNKS
+#include <hdf5.h>
+#include <zlib.h>
+// H5Dread_chunk and H5Dwrite_chunk appeared in HDF5 1.10.2
+#if !H5_VERSION_GE(1, 10, 2)
+#undef NETCDF4_DIRECT_CHUNKS
+#endif
+#endif
+#include "netcdf4-async.h"
+#include "async.h"
+#include "Schema.h"
+#include "ChunkEngine.h"
+
+namespace netcdf4async {
+
+std::atomic<uint64_t> chunk_engine_reads(0);
+std::atomic<uint64_t> chunk_engine_writes(0);
+std::atomic<uint64_t> chunk_engine_chunks(0);
+std::atomic<uint64_t> chunk_engine_fallbacks(0);
+
+/**
+ * @brief Tasks of one Run call
+ * Job stays in pool queue until all its tasks are taken
+ */
+struct ChunkThreads::Job {
+	const std::function<void(size_t)> *task;
+	size_t tasks;
+	size_t next;
+	size_t done;
+	std::mutex lock;
+	std::condition_variable finished;
+	/// @brief Count finished task and wake up caller of Run after last one
+	void Finish() {
+		std::lock_guard<std::mutex> guard(lock);
+		if (++done==tasks) {
+			finished.notify_all();
+		}
+	}
+};
+
+ChunkThreads::ChunkThreads() : size(0), running(0) {
+}
+
+/**
+ * @brief Pool instance
+ * Pool is never destroyed, its threads are detached and live until process exit
+ * @return ChunkThreads&
+ */
+ChunkThreads &ChunkThreads::Instance() {
+	static ChunkThreads *pool=new ChunkThreads();
+	return *pool;
+}
+
+/**
+ * @brief Change number of threads
+ * Extra threads are stopped after they finish current task
+ * @param size
+ */
+void ChunkThreads::Resize(size_t size) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		this->size=size;
+		if (running>0) {
+			Start();
+		}
+	}
+	ready.notify_all();
+}
+
+size_t ChunkThreads::Size() {
+	std::lock_guard<std::mutex> guard(lock);
+	return size;
+}
+
+/**
+ * @brief Start missing threads. Must be called under pool lock
+ */
+void ChunkThreads::Start() {
+	while (running<size) {
+		std::thread(&ChunkThreads::Loop, this).detach();
+		running++;
+	}
+}
+
+/**
+ * @brief Take next task of job. Must be called under pool lock
+ * @param job Job
+ * @param index Task index
+ * @return false if all tasks of job are taken
+ */
+bool ChunkThreads::Claim(const std::shared_ptr<Job> &job, size_t &index) {
+	if (job->next>=job->tasks) {
+		return false;
+	}
+	index=job->next++;
+	if (job->next==job->tasks) {
+		auto it=std::find(jobs.begin(), jobs.end(), job);
+		if (it!=jobs.end()) {
+			jobs.erase(it);
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Thread loop
+ */
+void ChunkThreads::Loop() {
+	std::unique_lock<std::mutex> guard(lock);
+	while (true) {
+		ready.wait(guard, [this] { return !jobs.empty() || running>size; });
+		if (running>size) {
+			running--;
+			return;
+		}
+		std::shared_ptr<Job> job=jobs.front();
+		size_t index;
+		if (!Claim(job, index)) {
+			continue;
+		}
+		guard.unlock();
+		(*job->task)(index);
+		job->Finish();
+		guard.lock();
+	}
+}
+
+void ChunkThreads::Run(size_t tasks, const std::function<void(size_t)> &task) {
+	if (tasks==0) {
+		return;
+	}
+	auto job=std::make_shared<Job>();
+	job->task=&task;
+	job->tasks=tasks;
+	job->next=0;
+	job->done=0;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		jobs.push_back(job);
+		Start();
+	}
+	ready.notify_all();
+	// Caller works on its own job too, so job completes even if all threads are busy
+	while (true) {
+		size_t index;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (!Claim(job, index)) {
+				break;
+			}
+		}
+		task(index);
+		job->Finish();
+	}
+	std::unique_lock<std::mutex> guard(job->lock);
+	job->finished.wait(guard, [&job] { return job->done==job->tasks; });
+}
+
+bool chunk_engine_available() {
+#ifdef NETCDF4_DIRECT_CHUNKS
+	return true;
+#else
+	return false;
+#endif
+}
+
+#ifdef NETCDF4_DIRECT_CHUNKS
+
+/// @brief Default property list, H5P_DEFAULT is defined with C cast
+const hid_t default_plist = 0;
+
+/**
+ * @brief Raw chunk as it is stored in file
+ */
+struct RawChunk {
+	/// @brief Coordinates of first value of chunk
+	std::vector<size_t> origin;
+	/// @brief Filtered chunk
+	std::vector<uint8_t> bytes;
+};
+
+/**
+ * @brief Silence HDF5 error stack printing while probing datasets
+ */
+class QuietErrors {
+	public:
+		QuietErrors() {
+			H5Eget_auto2(default_plist, &func, &data);
+			H5Eset_auto2(default_plist, NULL, NULL);
+		}
+		~QuietErrors() {
+			H5Eset_auto2(default_plist, func, data);
+		}
+	private:
+		H5E_auto2_t func;
+		void *data;
+};
+
+/**
+ * @brief Call function for each row of intersection of chunk and hyperslab
+ * @param origin Coordinates of first value of chunk
+ * @param chunks Chunk shape
+ * @param slab Hyperslab
+ * @param row Function called with offset of row in chunk, offset of row in hyperslab and row length, in values
+ */
+template<class Row> static void chunk_rows(const std::vector<size_t> &origin, const std::vector<size_t> &chunks,
+	const Hyperslab &slab, Row row) {
+	size_t ndims = chunks.size();
+	std::vector<size_t> lo(ndims), hi(ndims);
+	for (size_t d = 0; d < ndims; d++) {
+		lo[d] = std::max(origin[d], slab.start[d]);
+		hi[d] = std::min(origin[d] + chunks[d], slab.start[d] + slab.count[d]);
+	}
+	size_t len = hi[ndims - 1] - lo[ndims - 1];
+	std::vector<size_t> pos = lo;
+	while (true) {
+		size_t chunk_offset = 0;
+		size_t slab_offset = 0;
+		for (size_t d = 0; d < ndims; d++) {
+			chunk_offset = chunk_offset * chunks[d] + pos[d] - origin[d];
+			slab_offset = slab_offset * slab.count[d] + pos[d] - slab.start[d];
+		}
+		row(chunk_offset, slab_offset, len);
+		size_t d = ndims - 1;
+		while (d > 0) {
+			if (++pos[d - 1] < hi[d - 1]) {
+				break;
+			}
+			pos[d - 1] = lo[d - 1];
+			d--;
+		}
+		if (d == 0) {
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Copy values of intersection of chunk and hyperslab from chunk buffer to hyperslab buffer
+ * @param chunk Chunk values
+ * @param origin Coordinates of first value of chunk
+ * @param chunks Chunk shape
+ * @param values Hyperslab values
+ * @param slab Hyperslab
+ * @param type_size Size of value
+ */
+static void copy_chunk(const uint8_t *chunk, const std::vector<size_t> &origin, const std::vector<size_t> &chunks,
+	uint8_t *values, const Hyperslab &slab, size_t type_size) {
+	chunk_rows(origin, chunks, slab, [=] (size_t chunk_offset, size_t slab_offset, size_t len) {
+		memcpy(values + slab_offset * type_size, chunk + chunk_offset * type_size, len * type_size);
+	});
+}
+
+/**
+ * @brief Copy values of intersection of chunk and hyperslab from hyperslab buffer to chunk buffer
+ * @param values Hyperslab values
+ * @param slab Hyperslab
+ * @param chunk Chunk values
+ * @param origin Coordinates of first value of chunk
+ * @param chunks Chunk shape
+ * @param type_size Size of value
+ */
+static void gather_chunk(const uint8_t *values, const Hyperslab &slab, uint8_t *chunk, const std::vector<size_t> &origin,
+	const std::vector<size_t> &chunks, size_t type_size) {
+	chunk_rows(origin, chunks, slab, [=] (size_t chunk_offset, size_t slab_offset, size_t len) {
+		memcpy(chunk + chunk_offset * type_size, values + slab_offset * type_size, len * type_size);
+	});
+}
+
+/**
+ * @brief Revert HDF5 shuffle filter, which stores n-th bytes of all values together
+ */
+static void unshuffle(const uint8_t *src, uint8_t *dst, size_t elements, size_t type_size) {
+	for (size_t b = 0; b < type_size; b++) {
+		const uint8_t *plane = src + b * elements;
+		for (size_t i = 0; i < elements; i++) {
+			dst[i * type_size + b] = plane[i];
+		}
+	}
+}
+
+/**
+ * @brief Apply HDF5 shuffle filter
+ */
+static void shuffle_chunk(const uint8_t *src, uint8_t *dst, size_t elements, size_t type_size) {
+	for (size_t b = 0; b < type_size; b++) {
+		uint8_t *plane = dst + b * elements;
+		for (size_t i = 0; i < elements; i++) {
+			plane[i] = src[i * type_size + b];
+		}
+	}
+}
+
+/**
+ * @brief Origins of chunks holding hyperslab, in storage order
+ */
+static std::vector<std::vector<size_t>> chunk_origins(const Hyperslab &slab, const std::vector<size_t> &chunks) {
+	size_t ndims = chunks.size();
+	std::vector<size_t> first(ndims), last(ndims), index(ndims);
+	for (size_t d = 0; d < ndims; d++) {
+		first[d] = slab.start[d] / chunks[d];
+		last[d] = (slab.start[d] + slab.count[d] - 1) / chunks[d];
+	}
+	index = first;
+	std::vector<std::vector<size_t>> origins;
+	while (true) {
+		std::vector<size_t> origin(ndims);
+		for (size_t d = 0; d < ndims; d++) {
+			origin[d] = index[d] * chunks[d];
+		}
+		origins.push_back(origin);
+		size_t d = ndims;
+		while (d > 0) {
+			if (++index[d - 1] <= last[d - 1]) {
+				break;
+			}
+			index[d - 1] = first[d - 1];
+			d--;
+		}
+		if (d == 0) {
+			return origins;
+		}
+	}
+}
+
+/**
+ * @brief Check what dataset has only shuffle and deflate filters, the same chunks and holds hyperslab
+ * @param dataset Dataset
+ * @param slab Hyperslab
+ * @param chunks Chunk shape reported by libnetcdf
+ * @param shuffle Dataset is shuffled
+ * @param extent Dataset shape
+ * @return true if dataset could be accessed directly
+ */
+static bool check_dataset(hid_t dataset, const Hyperslab &slab, const std::vector<size_t> &chunks, bool &shuffle,
+	std::vector<hsize_t> &extent) {
+	size_t ndims = chunks.size();
+	hid_t plist = H5Dget_create_plist(dataset);
+	if (plist < 0) {
+		return false;
+	}
+	int filters = H5Pget_nfilters(plist);
+	bool ok = filters == 1 || filters == 2;
+	shuffle = false;
+	for (int i = 0; i < filters && ok; i++) {
+		unsigned int flags, config;
+		size_t nelements = 0;
+		H5Z_filter_t filter = H5Pget_filter2(plist, static_cast<unsigned>(i), &flags, &nelements, NULL, 0, NULL, &config);
+		if (filter == H5Z_FILTER_SHUFFLE && i == 0 && filters == 2) {
+			shuffle = true;
+		}
+		else if (filter != H5Z_FILTER_DEFLATE || i != filters - 1) {
+			ok = false;
+		}
+	}
+	extent.resize(ndims);
+	ok = ok && H5Pget_chunk(plist, static_cast<int>(ndims), extent.data()) == static_cast<int>(ndims);
+	for (size_t d = 0; d < ndims && ok; d++) {
+		ok = extent[d] == chunks[d];
+	}
+	H5Pclose(plist);
+	hid_t space = H5Dget_space(dataset);
+	if (space < 0) {
+		return false;
+	}
+	ok = ok && H5Sget_simple_extent_ndims(space) == static_cast<int>(ndims) &&
+		H5Sget_simple_extent_dims(space, extent.data(), NULL) >= 0;
+	for (size_t d = 0; d < ndims && ok; d++) {
+		ok = slab.start[d] + slab.count[d] <= extent[d];
+	}
+	H5Sclose(space);
+	return ok;
+}
+
+/**
+ * @brief Read raw chunks holding hyperslab
+ * @return false if some chunk is not allocated or stored unfiltered
+ */
+static bool read_raw(hid_t dataset, const Hyperslab &slab, const std::vector<size_t> &chunks, std::vector<RawChunk> &raw) {
+	std::vector<hsize_t> offset(chunks.size());
+	for (auto &origin : chunk_origins(slab, chunks)) {
+		RawChunk chunk;
+		chunk.origin = origin;
+		std::copy(origin.begin(), origin.end(), offset.begin());
+		hsize_t bytes = 0;
+		uint32_t mask = 0;
+		if (H5Dget_chunk_storage_size(dataset, offset.data(), &bytes) < 0 || bytes == 0) {
+			// Not allocated chunk holds fill values, libnetcdf handles it
+			return false;
+		}
+		chunk.bytes.resize(static_cast<size_t>(bytes));
+		if (H5Dread_chunk(dataset, default_plist, offset.data(), &mask, chunk.bytes.data()) < 0 || mask != 0) {
+			return false;
+		}
+		raw.push_back(std::move(chunk));
+	}
+	return true;
+}
+
+/**
+ * @brief Open variable dataset through HDF5. Must be called with netcdf lock held
+ * File is opened once more, HDF5 shares already open file (and its chunk caches) with libnetcdf
+ * @param path File path
+ * @param group Full group name
+ * @param name Variable name
+ * @param write Open file for writing
+ * @param file Opened file
+ * @param dataset Opened dataset
+ * @return false if dataset can't be opened, nothing is left open then
+ */
+static bool open_dataset(const std::string &path, const std::string &group, const std::string &name, bool write,
+	hid_t &file, hid_t &dataset) {
+	hid_t access = H5Pcreate(H5P_FILE_ACCESS);
+	if (access < 0) {
+		return false;
+	}
+	// Already open file may be opened again only with the same close degree, libnetcdf uses semi one
+	H5Pset_fclose_degree(access, H5F_CLOSE_SEMI);
+	file = H5Fopen(path.c_str(), write ? H5F_ACC_RDWR : H5F_ACC_RDONLY, access);
+	H5Pclose(access);
+	if (file < 0) {
+		return false;
+	}
+	std::string prefix = group == "/" ? group : group + "/";
+	// Variable named as dimension it does not define is stored under other name
+	dataset = H5Dopen2(file, (prefix + "_nc4_non_coord_" + name).c_str(), default_plist);
+	if (dataset < 0) {
+		dataset = H5Dopen2(file, (prefix + name).c_str(), default_plist);
+	}
+	if (dataset < 0) {
+		H5Fclose(file);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Fetch raw chunks of variable dataset. Must be called with netcdf lock held
+ * @return false if dataset can't be read directly
+ */
+static bool fetch_chunks(const std::string &path, const std::string &group, const std::string &name, const Hyperslab &slab,
+	const std::vector<size_t> &chunks, bool &shuffle, std::vector<RawChunk> &raw) {
+	QuietErrors quiet;
+	hid_t file, dataset;
+	if (!open_dataset(path, group, name, false, file, dataset)) {
+		return false;
+	}
+	std::vector<hsize_t> extent;
+	bool ok = check_dataset(dataset, slab, chunks, shuffle, extent) && read_raw(dataset, slab, chunks, raw);
+	H5Dclose(dataset);
+	H5Fclose(file);
+	return ok;
+}
+
+/**
+ * @brief File path, full group name and name of variable
+ * @return false on libnetcdf error
+ */
+static bool variable_location(int ncid, int varid, std::string &path, std::string &group, std::string &name) {
+	size_t len;
+	if (nc_inq_path(ncid, &len, NULL) != NC_NOERR) {
+		return false;
+	}
+	std::vector<char> buffer(len + 1);
+	if (nc_inq_path(ncid, &len, buffer.data()) != NC_NOERR) {
+		return false;
+	}
+	path = buffer.data();
+	if (nc_inq_grpname_full(ncid, &len, NULL) != NC_NOERR) {
+		return false;
+	}
+	buffer.resize(len + 1);
+	if (nc_inq_grpname_full(ncid, &len, buffer.data()) != NC_NOERR) {
+		return false;
+	}
+	group = buffer.data();
+	char var_name[NC_MAX_NAME + 1];
+	if (nc_inq_varname(ncid, varid, var_name) != NC_NOERR) {
+		return false;
+	}
+	name = var_name;
+	return true;
+}
+
+/**
+ * @brief Check what hyperslab of variable could be handled by chunk engine
+ * File must be netCDF-4 file on disk, variable must be chunked, deflated and stored in native byte order,
+ * and hyperslab must span several chunks
+ * @param ncid Group id
+ * @param varid Variable id
+ * @param type Variable type
+ * @param slab Hyperslab
+ * @param chunks Chunk shape
+ * @param level Deflate level
+ * @return true if engine could be used
+ */
+static bool deflated_variable(int ncid, int varid, int type, const Hyperslab &slab, std::vector<size_t> &chunks, int &level) {
+	if (ChunkThreads::Instance().Size() == 0 || typeSize(type) == 0 || type == NC_CHAR || type == NC_STRING ||
+		!slab.stride.empty() || slab.len == 0) {
+		return false;
+	}
+	int format, mode, ndims, storage, shuffle, deflate, endian;
+	// Files in memory are not visible to HDF5 by path
+	if (nc_inq_format_extended(ncid, &format, &mode) != NC_NOERR || format != NC_FORMATX_NC4 ||
+		(mode & (NC_DISKLESS | NC_INMEMORY)) != 0 ||
+		nc_inq_varndims(ncid, varid, &ndims) != NC_NOERR || ndims == 0 || static_cast<size_t>(ndims) != slab.start.size()) {
+		return false;
+	}
+	chunks.resize(ndims);
+	if (nc_inq_var_chunking(ncid, varid, &storage, chunks.data()) != NC_NOERR || storage != NC_CHUNKED ||
+		nc_inq_var_deflate(ncid, varid, &shuffle, &deflate, &level) != NC_NOERR || !deflate ||
+		nc_inq_var_endian(ncid, varid, &endian) != NC_NOERR ||
+		(endian != NC_ENDIAN_NATIVE && (endian == NC_ENDIAN_BIG) != big_endian_host)) {
+		return false;
+	}
+	// Single chunk is processed by libnetcdf as fast
+	size_t touched = 1;
+	for (int d = 0; d < ndims; d++) {
+		touched *= (slab.start[d] + slab.count[d] - 1) / chunks[d] - slab.start[d] / chunks[d] + 1;
+	}
+	return touched > 1;
+}
+
+#endif
+
+bool read_chunks(int ncid, int varid, int type, const Hyperslab &slab, void *data, std::unique_lock<std::mutex> &lock) {
+#ifdef NETCDF4_DIRECT_CHUNKS
+	std::vector<size_t> chunks;
+	int level;
+	if (!deflated_variable(ncid, varid, type, slab, chunks, level)) {
+		return false;
+	}
+	std::string path, group, name;
+	std::vector<RawChunk> raw;
+	bool shuffled;
+	if (!variable_location(ncid, varid, path, group, name) || !fetch_chunks(path, group, name, slab, chunks, shuffled, raw)) {
+		chunk_engine_fallbacks++;
+		return false;
+	}
+	size_t type_size = typeSize(type);
+	size_t elements = 1;
+	for (auto len : chunks) {
+		elements *= len;
+	}
+	size_t chunk_bytes = elements * type_size;
+	uint8_t *values = static_cast<uint8_t *>(data);
+	std::atomic<bool> failed(false);
+	lock.unlock();
+	ChunkThreads::Instance().Run(raw.size(), [&] (size_t i) {
+		std::vector<uint8_t> plain(chunk_bytes);
+		uLongf plain_len = chunk_bytes;
+		if (uncompress(plain.data(), &plain_len, raw[i].bytes.data(), raw[i].bytes.size()) != Z_OK || plain_len != chunk_bytes) {
+			failed = true;
+			return;
+		}
+		if (shuffled && type_size > 1) {
+			std::vector<uint8_t> ordered(chunk_bytes);
+			unshuffle(plain.data(), ordered.data(), elements, type_size);
+			plain.swap(ordered);
+		}
+		copy_chunk(plain.data(), raw[i].origin, chunks, values, slab, type_size);
+	});
+	lock.lock();
+	if (failed) {
+		chunk_engine_fallbacks++;
+		return false;
+	}
+	chunk_engine_reads++;
+	chunk_engine_chunks += raw.size();
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool write_chunks(int ncid, int varid, int type, const Hyperslab &slab, const void *data, std::unique_lock<std::mutex> &lock) {
+#ifdef NETCDF4_DIRECT_CHUNKS
+	std::vector<size_t> chunks;
+	int level;
+	if (!deflated_variable(ncid, varid, type, slab, chunks, level)) {
+		return false;
+	}
+	for (size_t d = 0; d < chunks.size(); d++) {
+		if (slab.start[d] % chunks[d] != 0) {
+			return false;
+		}
+	}
+	// Leaves define mode as nc_put_vara does and writes pending metadata, so dataset is complete on disk.
+	// Fails in define mode of classic model files, where nc_put_vara fails too
+	std::string path, group, name;
+	if (nc_sync(ncid) != NC_NOERR || !variable_location(ncid, varid, path, group, name)) {
+		return false;
+	}
+	size_t type_size = typeSize(type);
+	std::vector<uint8_t> fill(type_size, 0);
+	int no_fill;
+	if (nc_inq_var_fill(ncid, varid, &no_fill, fill.data()) != NC_NOERR) {
+		return false;
+	}
+	QuietErrors quiet;
+	hid_t file, dataset;
+	if (!open_dataset(path, group, name, true, file, dataset)) {
+		chunk_engine_fallbacks++;
+		return false;
+	}
+	bool shuffled;
+	std::vector<hsize_t> extent;
+	bool ok = check_dataset(dataset, slab, chunks, shuffled, extent);
+	// Every touched chunk must be written as a whole, only edge chunks may stick out of dataset
+	for (size_t d = 0; d < chunks.size() && ok; d++) {
+		ok = slab.count[d] % chunks[d] == 0 || slab.start[d] + slab.count[d] == extent[d];
+	}
+	if (!ok) {
+		H5Dclose(dataset);
+		H5Fclose(file);
+		chunk_engine_fallbacks++;
+		return false;
+	}
+	std::vector<RawChunk> raw;
+	for (auto &origin : chunk_origins(slab, chunks)) {
+		RawChunk chunk;
+		chunk.origin = origin;
+		raw.push_back(std::move(chunk));
+	}
+	size_t elements = 1;
+	for (auto len : chunks) {
+		elements *= len;
+	}
+	size_t chunk_bytes = elements * type_size;
+	const uint8_t *values = static_cast<const uint8_t *>(data);
+	std::atomic<bool> failed(false);
+	// Dataset stays open, the file can't be closed meanwhile as its executor runs this write
+	lock.unlock();
+	ChunkThreads::Instance().Run(raw.size(), [&] (size_t i) {
+		std::vector<uint8_t> plain(chunk_bytes);
+		bool edge = false;
+		for (size_t d = 0; d < chunks.size(); d++) {
+			edge = edge || raw[i].origin[d] + chunks[d] > extent[d];
+		}
+		// Part of edge chunk out of dataset holds fill values, as HDF5 writes it
+		for (size_t e = 0; edge && e < elements; e++) {
+			memcpy(plain.data() + e * type_size, fill.data(), type_size);
+		}
+		gather_chunk(values, slab, plain.data(), raw[i].origin, chunks, type_size);
+		if (shuffled && type_size > 1) {
+			std::vector<uint8_t> planes(chunk_bytes);
+			shuffle_chunk(plain.data(), planes.data(), elements, type_size);
+			plain.swap(planes);
+		}
+		uLongf packed_len = compressBound(chunk_bytes);
+		raw[i].bytes.resize(packed_len);
+		if (compress2(raw[i].bytes.data(), &packed_len, plain.data(), chunk_bytes, level) != Z_OK) {
+			failed = true;
+			return;
+		}
+		raw[i].bytes.resize(packed_len);
+	});
+	lock.lock();
+	std::vector<hsize_t> offset(chunks.size());
+	for (size_t i = 0; i < raw.size() && !failed; i++) {
+		std::copy(raw[i].origin.begin(), raw[i].origin.end(), offset.begin());
+		// Direct write replaces chunk in file and drops its cached copy
+		if (H5Dwrite_chunk(dataset, default_plist, 0, offset.data(), raw[i].bytes.size(), raw[i].bytes.data()) < 0) {
+			failed = true;
+		}
+	}
+	H5Dclose(dataset);
+	H5Fclose(file);
+	if (failed) {
+		chunk_engine_fallbacks++;
+		return false;
+	}
+	chunk_engine_writes++;
+	chunk_engine_chunks += raw.size();
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * @brief Write of hyperslab which may be compressed by chunk engine
+ * Falls back to nc_put_vara for hyperslabs engine does not handle
+ */
+class ChunkWriteWorker : public AsyncPromiseWorker {
+	public:
+		ChunkWriteWorker(Napi::Env &env, Napi::Promise::Deferred deferred, int ncid, int varid, int type, const Hyperslab &slab, void *data)
+			: AsyncPromiseWorker(env, deferred), ncid(ncid), varid(varid), type(type), slab(slab), data(data) {
+		}
+		~ChunkWriteWorker() {
+			BufferPool::Instance().Release(data);
+		}
+	protected:
+		void Execute() override {
+			// Chunk engine releases lock while compressing chunks
+			std::unique_lock<std::mutex> lock(netcdf_lock());
+			if (!write_chunks(ncid, varid, type, slab, data, lock)) {
+				NC_CALL(nc_put_vara(ncid, varid, slab.start.data(), slab.count.data(), data));
+			}
+			SchemaRegistry::Instance().RefreshLengths(ncid, varid);
+		}
+		void OnOK() override {
+			Release();
+			Deferred().Resolve(Napi::String::New(Env(), "OK"));
+		}
+	private:
+		int ncid;
+		int varid;
+		int type;
+		Hyperslab slab;
+		void *data;
+};
+
+Napi::Promise chunk_write(Napi::Env env, Napi::Promise::Deferred deferred, int ncid, int varid, int type, const Hyperslab &slab, void *data, const FileToken &token) {
+	auto worker = new ChunkWriteWorker(env, deferred, ncid, varid, type, slab, data);
+	worker->Queue(ncid, token);
+	return deferred.Promise();
+}
+
+}
@@ -0,0 +1,110 @@
+#ifndef NETCDF4_CHUNK_ENGINE_H
+#define NETCDF4_CHUNK_ENGINE_H
+
+#include <napi.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "Macros.h"
+#include "async.h"
+
+namespace netcdf4async {
+
+    /// @brief Number of reads served by parallel chunk engine
+    extern std::atomic<uint64_t> chunk_engine_reads;
+    /// @brief Number of writes served by parallel chunk engine
+    extern std::atomic<uint64_t> chunk_engine_writes;
+    /// @brief Number of chunks decompressed or compressed by parallel chunk engine
+    extern std::atomic<uint64_t> chunk_engine_chunks;
+    /// @brief Number of reads and writes planned for engine which were done by libnetcdf after all
+    extern std::atomic<uint64_t> chunk_engine_fallbacks;
+
+    /**
+     * @brief Process-wide pool of threads compressing and decompressing chunks
+     * Separate from I/O pool, as I/O threads wait for chunk jobs to complete.
+     * Pool is empty and engine is disabled until size is set through `configure({chunkThreads})`
+     */
+    class ChunkThreads {
+        public:
+            /// @brief Pool instance
+            /// @return pool
+            static ChunkThreads &Instance();
+            /// @brief Change number of threads
+            /// @param size New number of threads, 0 disables chunk engine
+            void Resize(size_t size);
+            /// @brief Number of threads
+            /// @return pool size
+            size_t Size();
+            /// @brief Run tasks on pool threads and calling thread, return when all are done
+            /// @param tasks Number of tasks
+            /// @param task Task function called with task index, must not throw
+            void Run(size_t tasks, const std::function<void(size_t)> &task);
+        private:
+            struct Job;
+            ChunkThreads();
+            void Start();
+            void Loop();
+            bool Claim(const std::shared_ptr<Job> &job, size_t &index);
+            std::mutex lock;
+            std::condition_variable ready;
+            std::deque<std::shared_ptr<Job>> jobs;
+            size_t size;
+            size_t running;
+    };
+
+    /// @brief Chunk engine is compiled in, i.e. addon was built with HDF5 and zlib
+    bool chunk_engine_available();
+
+    /**
+     * @brief Read hyperslab of deflated netCDF-4 variable with parallel decompression
+     * Raw chunks are fetched with H5Dread_chunk under netcdf lock, then lock is released and chunks
+     * are inflated, unshuffled and copied to destination by chunk threads.
+     * Engine is used only for contiguous hyperslabs spanning several allocated chunks of variables
+     * with deflate (and shuffle) filters and native byte order; otherwise nothing is read
+     * @param ncid Group id
+     * @param varid Variable id
+     * @param type Variable type
+     * @param slab Hyperslab
+     * @param data Destination
+     * @param lock Held netcdf lock, it is held again on return
+     * @return true if hyperslab was read, false if it must be read by libnetcdf
+     */
+    bool read_chunks(int ncid, int varid, int type, const Hyperslab &slab, void *data, std::unique_lock<std::mutex> &lock);
+
+    /**
+     * @brief Write chunk-aligned hyperslab of deflated netCDF-4 variable with parallel compression
+     * Chunks are gathered, shuffled and deflated by chunk threads without netcdf lock, then stored
+     * with H5Dwrite_chunk under the lock, so file stays readable by libnetcdf.
+     * Hyperslab must start at chunk boundaries and cover whole chunks, except edge chunks of dataset,
+     * other requirements are the same as for reads; otherwise nothing is written
+     * @param ncid Group id
+     * @param varid Variable id
+     * @param type Variable type
+     * @param slab Hyperslab
+     * @param data Values
+     * @param lock Held netcdf lock, it is held again on return
+     * @return true if hyperslab was written, false if it must be written by libnetcdf
+     */
+    bool write_chunks(int ncid, int varid, int type, const Hyperslab &slab, const void *data, std::unique_lock<std::mutex> &lock);
+
+    /**
+     * @brief Write hyperslab through chunk engine, or libnetcdf if engine can't handle it
+     * @param env NodeJS environment
+     * @param deferred Deferred promise
+     * @param ncid Group id
+     * @param varid Variable id
+     * @param type Variable type
+     * @param slab Hyperslab
+     * @param data Values taken from buffer pool, released when write is done
+     * @param token Closed flag of file, see FileToken
+     * @return Promise
+     */
+    Napi::Promise chunk_write(Napi::Env env, Napi::Promise::Deferred deferred, int ncid, int varid, int type, const Hyperslab &slab, void *data, const FileToken &token);
+
+}
+
+#endif
@@ -0,0 +1,731 @@
+#include <netcdf.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#include "netcdf4-async.h"
+#include "async.h"
+#include "ClassicReader.h"
+
+namespace netcdf4async {
+
+std::atomic<uint64_t> classic_reader_reads(0);
+std::atomic<uint64_t> classic_reader_views(0);
+
+/// @brief Readers of open files by file id
+static std::map<int, std::shared_ptr<ClassicReader>> readers;
+/// @brief Guard for readers registry, readers are attached in I/O threads
+static std::mutex readers_lock;
+
+/// @brief Header tags, see netCDF classic format specification
+const uint32_t nc_dimension_tag = 0x0A;
+const uint32_t nc_variable_tag = 0x0B;
+const uint32_t nc_attribute_tag = 0x0C;
+/// @brief Number of records of file being written in streaming mode
+const uint32_t streaming_numrecs = 0xFFFFFFFF;
+
+#if defined(_MSC_VER)
+static inline uint16_t bswap16(uint16_t v) { return _byteswap_ushort(v); }
+static inline uint32_t bswap32(uint32_t v) { return _byteswap_ulong(v); }
+static inline uint64_t bswap64(uint64_t v) { return _byteswap_uint64(v); }
+#else
+static inline uint16_t bswap16(uint16_t v) { return __builtin_bswap16(v); }
+static inline uint32_t bswap32(uint32_t v) { return __builtin_bswap32(v); }
+static inline uint64_t bswap64(uint64_t v) { return __builtin_bswap64(v); }
+#endif
+
+/**
+ * @brief Swap bytes of values one by one. Values may be unaligned
+ */
+static void swap_scalar(uint8_t *dst, const uint8_t *src, size_t count, size_t size) {
+	switch (size) {
+	case 2:
+		for (size_t i = 0; i < count; i++) {
+			uint16_t v;
+			memcpy(&v, src + i * 2, 2);
+			v = bswap16(v);
+			memcpy(dst + i * 2, &v, 2);
+		}
+		break;
+	case 4:
+		for (size_t i = 0; i < count; i++) {
+			uint32_t v;
+			memcpy(&v, src + i * 4, 4);
+			v = bswap32(v);
+			memcpy(dst + i * 4, &v, 4);
+		}
+		break;
+	case 8:
+		for (size_t i = 0; i < count; i++) {
+			uint64_t v;
+			memcpy(&v, src + i * 8, 8);
+			v = bswap64(v);
+			memcpy(dst + i * 8, &v, 8);
+		}
+		break;
+	}
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NC_SIMD_SWAP 1
+/**
+ * @brief Swap bytes of 16 byte blocks with SSSE3 shuffle. Built for SSSE3 regardless of compiler flags,
+ * used only if CPU supports it
+ * @return Number of values swapped, the rest is left to scalar loop
+ */
+__attribute__((target("ssse3")))
+static size_t swap_simd(uint8_t *dst, const uint8_t *src, size_t count, size_t size) {
+	__m128i mask;
+	switch (size) {
+	case 2:
+		mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+		break;
+	case 4:
+		mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		break;
+	default:
+		mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+		break;
+	}
+	size_t blocks = count * size / 16;
+	for (size_t i = 0; i < blocks; i++) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 16));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 16), _mm_shuffle_epi8(v, mask));
+	}
+	return blocks * 16 / size;
+}
+
+static bool simd_supported() {
+	static const bool supported = __builtin_cpu_supports("ssse3");
+	return supported;
+}
+#elif defined(__aarch64__)
+#define NC_SIMD_SWAP 1
+/**
+ * @brief Swap bytes of 16 byte blocks with NEON byte reverse
+ * @return Number of values swapped, the rest is left to scalar loop
+ */
+static size_t swap_simd(uint8_t *dst, const uint8_t *src, size_t count, size_t size) {
+	size_t blocks = count * size / 16;
+	for (size_t i = 0; i < blocks; i++) {
+		uint8x16_t v = vld1q_u8(src + i * 16);
+		switch (size) {
+		case 2:
+			v = vrev16q_u8(v);
+			break;
+		case 4:
+			v = vrev32q_u8(v);
+			break;
+		default:
+			v = vrev64q_u8(v);
+			break;
+		}
+		vst1q_u8(dst + i * 16, v);
+	}
+	return blocks * 16 / size;
+}
+
+static bool simd_supported() {
+	return true;
+}
+#endif
+
+void big_endian_to_native(void *dst, const void *src, size_t count, size_t size) {
+	uint8_t *out = static_cast<uint8_t *>(dst);
+	const uint8_t *in = static_cast<const uint8_t *>(src);
+	if (big_endian_host || size == 1) {
+		if (out != in) {
+			memcpy(out, in, count * size);
+		}
+		return;
+	}
+	size_t done = 0;
+#ifdef NC_SIMD_SWAP
+	if (simd_supported()) {
+		done = swap_simd(out, in, count, size);
+	}
+#endif
+	swap_scalar(out + done * size, in + done * size, count - done, size);
+}
+
+/**
+ * @brief Size of value of netCDF-3 type
+ * @param type Type
+ * @param version Format version, CDF-5 adds unsigned and 64 bit types
+ * @return size or 0 if type is not allowed
+ */
+static size_t classic_type_size(int type, int version) {
+	if (type > NC_DOUBLE && version != 5) {
+		return 0;
+	}
+	return type <= NC_UINT64 ? typeSize(type) : 0;
+}
+
+/**
+ * @brief Bounds checked reader of big-endian header fields
+ */
+class HeaderCursor {
+	public:
+		HeaderCursor(const uint8_t *data, size_t size, int version) : p(data), end(data + size), version(version), ok(true) {
+		}
+		uint32_t U32() {
+			uint32_t v = 0;
+			if (Take(4)) {
+				memcpy(&v, p - 4, 4);
+				big_endian_to_native(&v, &v, 1, 4);
+			}
+			return v;
+		}
+		uint64_t U64() {
+			uint64_t v = 0;
+			if (Take(8)) {
+				memcpy(&v, p - 8, 8);
+				big_endian_to_native(&v, &v, 1, 8);
+			}
+			return v;
+		}
+		/// @brief Non-negative count, 64 bit in CDF-5
+		uint64_t Count() {
+			return version == 5 ? U64() : U32();
+		}
+		/// @brief Skip name, it is padded to 4 bytes
+		void SkipName() {
+			Skip(Count());
+		}
+		/// @brief Skip bytes padded to 4 bytes
+		void Skip(uint64_t bytes) {
+			if (bytes > std::numeric_limits<uint64_t>::max() - 3) {
+				ok = false;
+				return;
+			}
+			Take((bytes + 3) & ~static_cast<uint64_t>(3));
+		}
+		/// @brief Skip attribute list
+		void SkipAttributes() {
+			uint32_t tag = U32();
+			uint64_t n = Count();
+			if (tag != nc_attribute_tag && !(tag == 0 && n == 0)) {
+				ok = false;
+			}
+			for (uint64_t i = 0; i < n && ok; i++) {
+				SkipName();
+				size_t type_size = classic_type_size(static_cast<int>(U32()), version);
+				uint64_t nelems = Count();
+				if (type_size == 0 || nelems > std::numeric_limits<uint64_t>::max() / type_size) {
+					ok = false;
+					return;
+				}
+				Skip(nelems * type_size);
+			}
+		}
+		bool Ok() const {
+			return ok;
+		}
+	private:
+		bool Take(uint64_t bytes) {
+			if (!ok || bytes > static_cast<uint64_t>(end - p)) {
+				ok = false;
+				return false;
+			}
+			p += bytes;
+			return true;
+		}
+		const uint8_t *p;
+		const uint8_t *end;
+		int version;
+		bool ok;
+};
+
+/**
+ * @brief Multiply sizes, failing on overflow
+ */
+static bool checked_mul(uint64_t a, uint64_t b, uint64_t &result) {
+	if (a != 0 && b > std::numeric_limits<uint64_t>::max() / a) {
+		return false;
+	}
+	result = a * b;
+	return true;
+}
+
+ClassicReader::ClassicReader() : data(nullptr), view_data(nullptr), size(0), views(false), numrecs(0), recsize(0) {
+#ifdef _WIN32
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+#endif
+}
+
+ClassicReader::~ClassicReader() {
+#ifdef _WIN32
+	if (data != nullptr) {
+		UnmapViewOfFile(data);
+	}
+	if (view_data != nullptr) {
+		UnmapViewOfFile(view_data);
+	}
+	if (mapping != NULL) {
+		CloseHandle(mapping);
+	}
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+#else
+	if (data != nullptr) {
+		munmap(data, size);
+	}
+	if (view_data != nullptr) {
+		munmap(view_data, size);
+	}
+#endif
+}
+
+std::shared_ptr<ClassicReader> ClassicReader::Open(const std::string &path, bool views) {
+	std::shared_ptr<ClassicReader> reader(new ClassicReader());
+	reader->views = views;
+	// Reads copy values from read only mapping. Views are given out of separate copy-on-write mapping,
+	// so changes of returned arrays reach neither file nor copying reads
+#ifdef _WIN32
+	reader->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	LARGE_INTEGER file_size;
+	if (reader->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(reader->file, &file_size) || file_size.QuadPart < 4) {
+		return nullptr;
+	}
+	reader->mapping = CreateFileMappingA(reader->file, NULL, views ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+	if (reader->mapping == NULL) {
+		return nullptr;
+	}
+	void *data = MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL) {
+		return nullptr;
+	}
+	reader->data = static_cast<uint8_t *>(data);
+	if (views) {
+		void *view_data = MapViewOfFile(reader->mapping, FILE_MAP_COPY, 0, 0, 0);
+		if (view_data == NULL) {
+			return nullptr;
+		}
+		reader->view_data = static_cast<uint8_t *>(view_data);
+	}
+	reader->size = static_cast<size_t>(file_size.QuadPart);
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return nullptr;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < 4) {
+		close(fd);
+		return nullptr;
+	}
+	void *data = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	void *view_data = views ? mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : NULL;
+	close(fd);
+	reader->size = static_cast<size_t>(st.st_size);
+	if (data != MAP_FAILED) {
+		reader->data = static_cast<uint8_t *>(data);
+	}
+	if (view_data != MAP_FAILED) {
+		reader->view_data = static_cast<uint8_t *>(view_data);
+	}
+	if (data == MAP_FAILED || view_data == MAP_FAILED) {
+		return nullptr;
+	}
+#endif
+	if (!reader->Parse()) {
+		return nullptr;
+	}
+	return reader;
+}
+
+/**
+ * @brief Parse header and check what data of all variables is within file
+ * @return false if file is not netCDF-3 file or it is damaged or still being written
+ */
+bool ClassicReader::Parse() {
+	if (memcmp(data, "CDF", 3) != 0 || (data[3] != 1 && data[3] != 2 && data[3] != 5)) {
+		return false;
+	}
+	int version = data[3];
+	HeaderCursor cursor(data + 4, size - 4, version);
+	uint64_t records = cursor.Count();
+	if (version != 5 && records == streaming_numrecs) {
+		return false;
+	}
+	numrecs = static_cast<size_t>(records);
+
+	std::vector<uint64_t> dims;
+	uint32_t tag = cursor.U32();
+	uint64_t n = cursor.Count();
+	if (tag != nc_dimension_tag && !(tag == 0 && n == 0)) {
+		return false;
+	}
+	for (uint64_t i = 0; i < n && cursor.Ok(); i++) {
+		cursor.SkipName();
+		dims.push_back(cursor.Count());
+	}
+	cursor.SkipAttributes();
+
+	tag = cursor.U32();
+	n = cursor.Count();
+	if (tag != nc_variable_tag && !(tag == 0 && n == 0)) {
+		return false;
+	}
+	size_t record_vars = 0;
+	uint64_t last_record_size = 0;
+	for (uint64_t i = 0; i < n && cursor.Ok(); i++) {
+		Var var;
+		cursor.SkipName();
+		uint64_t ndims = cursor.Count();
+		if (ndims > NC_MAX_VAR_DIMS) {
+			return false;
+		}
+		std::vector<uint64_t> dimids;
+		for (uint64_t d = 0; d < ndims; d++) {
+			dimids.push_back(cursor.Count());
+		}
+		cursor.SkipAttributes();
+		var.type = static_cast<int>(cursor.U32());
+		cursor.Count();
+		var.begin = version == 1 ? cursor.U32() : cursor.U64();
+		var.type_size = classic_type_size(var.type, version);
+		if (!cursor.Ok() || var.type_size == 0) {
+			return false;
+		}
+		var.record = false;
+		uint64_t bytes = var.type_size;
+		for (uint64_t d = 0; d < ndims; d++) {
+			if (dimids[d] >= dims.size()) {
+				return false;
+			}
+			uint64_t len = dims[dimids[d]];
+			if (len == 0) {
+				// Only first dimension could be unlimited
+				if (d != 0) {
+					return false;
+				}
+				var.record = true;
+				len = numrecs;
+			}
+			else if (!checked_mul(bytes, len, bytes)) {
+				return false;
+			}
+			var.shape.push_back(static_cast<size_t>(len));
+		}
+		if (var.record) {
+			record_vars++;
+			last_record_size = bytes;
+			uint64_t padded = (bytes + 3) & ~static_cast<uint64_t>(3);
+			if (padded < bytes || recsize > std::numeric_limits<uint64_t>::max() - padded) {
+				return false;
+			}
+			recsize += padded;
+		}
+		else if (var.begin > size || bytes > size - var.begin) {
+			return false;
+		}
+		vars.push_back(var);
+	}
+	if (!cursor.Ok()) {
+		return false;
+	}
+	// Records of the only record variable are not padded
+	if (record_vars == 1) {
+		recsize = last_record_size;
+	}
+	for (auto &var : vars) {
+		if (var.record && numrecs > 0) {
+			uint64_t last;
+			if (!checked_mul(numrecs - 1, recsize, last) || var.begin > size || last > size - var.begin) {
+				return false;
+			}
+			uint64_t bytes = var.type_size;
+			for (size_t d = 1; d < var.shape.size(); d++) {
+				bytes *= var.shape[d];
+			}
+			if (bytes > size - var.begin - last) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Check hyperslab as libnetcdf does
+ * @param varid Variable id
+ * @param slab Hyperslab
+ * @param shape Variable shape
+ * @return NetCDF status
+ */
+int ClassicReader::Locate(int varid, const Hyperslab &slab, std::vector<size_t> &shape) const {
+	if (varid < 0 || static_cast<size_t>(varid) >= vars.size()) {
+		return NC_ENOTVAR;
+	}
+	shape = vars[varid].shape;
+	if (slab.start.size() != shape.size() || slab.count.size() != shape.size() ||
+		(!slab.stride.empty() && slab.stride.size() != shape.size())) {
+		return NC_EINVAL;
+	}
+	for (size_t d = 0; d < shape.size(); d++) {
+		if (!slab.stride.empty() && slab.stride[d] <= 0) {
+			return NC_ESTRIDE;
+		}
+		if (slab.start[d] > shape[d] || (slab.count[d] > 0 && slab.start[d] == shape[d])) {
+			return NC_EINVALCOORDS;
+		}
+		size_t stride = slab.stride.empty() ? 1 : static_cast<size_t>(slab.stride[d]);
+		if (slab.count[d] > 0 && (slab.count[d] - 1) > (shape[d] - slab.start[d] - 1) / stride) {
+			return NC_EEDGE;
+		}
+	}
+	return NC_NOERR;
+}
+
+/**
+ * @brief Byte offset of value in file
+ * @param shape Variable shape
+ * @param record Variable is record variable
+ * @param begin Offset of variable data
+ * @param type_size Size of value
+ * @param recsize Size of record
+ * @param coords Coordinates of value
+ * @return Offset
+ */
+static uint64_t value_offset(const std::vector<size_t> &shape, bool record, uint64_t begin, size_t type_size, uint64_t recsize,
+	const std::vector<size_t> &coords) {
+	uint64_t element = 0;
+	for (size_t d = record ? 1 : 0; d < shape.size(); d++) {
+		element = element * shape[d] + coords[d];
+	}
+	uint64_t offset = begin + element * type_size;
+	if (record) {
+		offset += coords[0] * recsize;
+	}
+	return offset;
+}
+
+int ClassicReader::Read(int varid, const Hyperslab &slab, void *data) const {
+	std::vector<size_t> shape;
+	int status = Locate(varid, slab, shape);
+	if (status != NC_NOERR) {
+		return status;
+	}
+	const Var &var = vars[varid];
+	uint8_t *out = static_cast<uint8_t *>(data);
+	size_t ndims = shape.size();
+	if (ndims == 0) {
+		big_endian_to_native(out, this->data + var.begin, 1, var.type_size);
+		return NC_NOERR;
+	}
+	size_t total = 1;
+	for (auto count : slab.count) {
+		total *= count;
+	}
+	if (total == 0) {
+		return NC_NOERR;
+	}
+	size_t last = ndims - 1;
+	size_t row = slab.count[last];
+	size_t step = slab.stride.empty() ? 1 : static_cast<size_t>(slab.stride[last]);
+	// Values along record dimension are one record apart
+	uint64_t pitch = (var.record && last == 0 ? recsize : var.type_size) * step;
+	std::vector<size_t> index(ndims, 0);
+	std::vector<size_t> coords(ndims);
+	for (size_t r = 0; r < total / row; r++) {
+		for (size_t d = 0; d < ndims; d++) {
+			coords[d] = slab.start[d] + index[d] * (slab.stride.empty() ? 1 : static_cast<size_t>(slab.stride[d]));
+		}
+		const uint8_t *src = this->data + value_offset(shape, var.record, var.begin, var.type_size, recsize, coords);
+		if (pitch == var.type_size) {
+			big_endian_to_native(out, src, row, var.type_size);
+		}
+		else {
+			for (size_t k = 0; k < row; k++) {
+				memcpy(out + k * var.type_size, src + k * pitch, var.type_size);
+			}
+			big_endian_to_native(out, out, row, var.type_size);
+		}
+		out += row * var.type_size;
+		for (size_t d = last; d > 0; d--) {
+			if (++index[d - 1] < slab.count[d - 1]) {
+				break;
+			}
+			index[d - 1] = 0;
+		}
+	}
+	return NC_NOERR;
+}
+
+uint8_t *ClassicReader::View(int varid, const Hyperslab &slab) const {
+	std::vector<size_t> shape;
+	if (view_data == nullptr || Locate(varid, slab, shape) != NC_NOERR || shape.empty()) {
+		return nullptr;
+	}
+	const Var &var = vars[varid];
+	if (!big_endian_host && var.type_size != 1) {
+		return nullptr;
+	}
+	for (auto stride : slab.stride) {
+		if (stride != 1) {
+			return nullptr;
+		}
+	}
+	// Hyperslab is contiguous if it takes whole inner dimensions and single rows of outer ones
+	size_t d = shape.size();
+	while (d > 0 && slab.count[d - 1] == shape[d - 1]) {
+		d--;
+	}
+	for (size_t outer = 0; outer + 1 < d; outer++) {
+		if (slab.count[outer] != 1) {
+			return nullptr;
+		}
+	}
+	// Records are interleaved with other record variables
+	if (var.record && slab.count[0] != 1) {
+		return nullptr;
+	}
+	for (auto count : slab.count) {
+		if (count == 0) {
+			return nullptr;
+		}
+	}
+	return view_data + value_offset(shape, var.record, var.begin, var.type_size, recsize, slab.start);
+}
+
+bool ClassicReader::Views() const {
+	return views;
+}
+
+void ClassicReader::Attach(int id, const std::shared_ptr<ClassicReader> &reader) {
+	std::lock_guard<std::mutex> lock(readers_lock);
+	readers[id] = reader;
+}
+
+void ClassicReader::Detach(int id) {
+	std::lock_guard<std::mutex> lock(readers_lock);
+	readers.erase(id);
+}
+
+std::shared_ptr<ClassicReader> ClassicReader::Find(int ncid) {
+	std::lock_guard<std::mutex> lock(readers_lock);
+	auto it = readers.find(NC_FILE_ID(ncid));
+	return it == readers.end() ? nullptr : it->second;
+}
+
+/**
+ * @brief TypedArray type of values which could be viewed without conversion
+ */
+static bool view_array_type(int type, napi_typedarray_type &array_type) {
+	switch (type) {
+	case NC_BYTE:
+		array_type = napi_int8_array;
+		return true;
+	case NC_UBYTE:
+		array_type = napi_uint8_array;
+		return true;
+	case NC_SHORT:
+		array_type = napi_int16_array;
+		return true;
+	case NC_USHORT:
+		array_type = napi_uint16_array;
+		return true;
+	case NC_INT:
+		array_type = napi_int32_array;
+		return true;
+	case NC_UINT:
+		array_type = napi_uint32_array;
+		return true;
+	case NC_FLOAT:
+		array_type = napi_float32_array;
+		return true;
+	case NC_DOUBLE:
+		array_type = napi_float64_array;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Worker reading hyperslab through classic reader
+ * Runs without netcdf lock and without file executor, so reads of one file run in parallel
+ */
+class ClassicReadWorker : public AsyncPromiseWorker {
+	public:
+		ClassicReadWorker(Napi::Env &env, Napi::Promise::Deferred deferred, const std::shared_ptr<ClassicReader> &reader,
+			int varid, int type, const Hyperslab &slab)
+			: AsyncPromiseWorker(env, deferred), reader(reader), varid(varid), slab(slab), view(nullptr) {
+			result.type = type;
+			result.len = slab.len;
+			result.value.v = NULL;
+		}
+	protected:
+		void Execute() override {
+			classic_reader_reads++;
+			napi_typedarray_type array_type;
+			if (reader->Views() && external_buffers && slab.len > 1 && view_array_type(result.type, array_type)) {
+				view = reader->View(varid, slab);
+				if (view != nullptr) {
+					classic_reader_views++;
+					return;
+				}
+			}
+			typedValue(&result);
+			int status = reader->Read(varid, slab, result.value.v);
+			if (status != NC_NOERR) {
+				BufferPool::Instance().Release(result.value.v);
+				NC_CALL(status);
+			}
+		}
+		void OnOK() override {
+			Release();
+			Napi::Env env = Env();
+			if (view == nullptr) {
+				Deferred().Resolve(item2value(env, &result));
+				return;
+			}
+			napi_typedarray_type array_type = napi_uint8_array;
+			view_array_type(result.type, array_type);
+			// Mapping is kept while any view of it is alive
+			auto buffer = Napi::ArrayBuffer::New(env, view, slab.len * typeSize(result.type),
+				[] (Napi::Env env, void *data, std::shared_ptr<ClassicReader> *reader) {
+					delete reader;
+				},
+				new std::shared_ptr<ClassicReader>(reader));
+			napi_value array;
+			napi_status status = napi_create_typedarray(env, array_type, slab.len, buffer, 0, &array);
+			if (status != napi_ok) {
+				throw Napi::Error::New(env);
+			}
+			Deferred().Resolve(Napi::Value(env, array));
+		}
+	private:
+		std::shared_ptr<ClassicReader> reader;
+		int varid;
+		Hyperslab slab;
+		Item result;
+		uint8_t *view;
+};
+
+Napi::Promise classic_read(Napi::Env env, Napi::Promise::Deferred deferred, const std::shared_ptr<ClassicReader> &reader,
+	int varid, int type, const Hyperslab &slab) {
+	auto worker = new ClassicReadWorker(env, deferred, reader, varid, type, slab);
+	worker->Queue();
+	return deferred.Promise();
+}
+
+}
@@ -0,0 +1,110 @@
+#ifndef NETCDF4_CLASSIC_READER_H
+#define NETCDF4_CLASSIC_READER_H
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Macros.h"
+
+namespace netcdf4async {
+
+    /// @brief Number of reads served by native classic reader
+    extern std::atomic<uint64_t> classic_reader_reads;
+    /// @brief Number of reads resolved to views of mapped file without copy
+    extern std::atomic<uint64_t> classic_reader_views;
+
+    /**
+     * @brief Convert big-endian values to native byte order
+     * Uses SIMD shuffles where CPU supports them
+     * @param dst Destination, may be equal to src
+     * @param src Big-endian values
+     * @param count Number of values
+     * @param size Size of value: 1, 2, 4 or 8
+     */
+    void big_endian_to_native(void *dst, const void *src, size_t count, size_t size);
+
+    /**
+     * @brief Thread-safe reader of netCDF-3 (classic, 64-bit offset and CDF-5) files
+     * Header is parsed once and file is mapped into memory, so variables are read
+     * without libnetcdf and without netcdf lock, by many I/O threads at once.
+     * Reader is attached to read only file id and lives while reads using it are in progress
+     */
+    class ClassicReader {
+        public:
+            /// @brief Map file and parse its header
+            /// @param path File path
+            /// @param views Reads may be resolved to views of mapped file
+            /// @return Reader or empty pointer if file is not a supported netCDF-3 file
+            static std::shared_ptr<ClassicReader> Open(const std::string &path, bool views);
+            /// @brief Use reader for reads of file
+            /// @param id NetCDF file id
+            /// @param reader Reader
+            static void Attach(int id, const std::shared_ptr<ClassicReader> &reader);
+            /// @brief Stop using reader of file, e.g. when file is closing
+            /// @param id NetCDF file id
+            static void Detach(int id);
+            /// @brief Reader of file which owns group
+            /// @param ncid NetCDF file or group id
+            /// @return Reader or empty pointer
+            static std::shared_ptr<ClassicReader> Find(int ncid);
+            /// @brief Read hyperslab of variable, converting values to native byte order
+            /// @param varid Variable id
+            /// @param slab Hyperslab
+            /// @param data Destination
+            /// @return NetCDF status, the same libnetcdf returns for wrong hyperslab
+            int Read(int varid, const Hyperslab &slab, void *data) const;
+            /// @brief Values of hyperslab in copy-on-write mapping of file, if they could be used as they are:
+            /// hyperslab is contiguous in file and values are in native byte order.
+            /// Changes of views do not reach file and values returned by Read
+            /// @param varid Variable id
+            /// @param slab Hyperslab
+            /// @return Pointer into mapping or nullptr, also for wrong hyperslab
+            uint8_t *View(int varid, const Hyperslab &slab) const;
+            /// @brief Reads may be resolved to views of mapped file
+            bool Views() const;
+            ~ClassicReader();
+        private:
+            struct Var {
+                int type;
+                size_t type_size;
+                std::vector<size_t> shape;
+                bool record;
+                uint64_t begin;
+            };
+            ClassicReader();
+            bool Parse();
+            int Locate(int varid, const Hyperslab &slab, std::vector<size_t> &shape) const;
+            /// @brief Read only mapping of file
+            uint8_t *data;
+            /// @brief Copy-on-write mapping of file for views, only if views are enabled
+            uint8_t *view_data;
+            size_t size;
+            bool views;
+            size_t numrecs;
+            uint64_t recsize;
+            std::vector<Var> vars;
+#ifdef _WIN32
+            void *file;
+            void *mapping;
+#endif
+    };
+
+    /**
+     * @brief Read hyperslab through native classic reader of file
+     * @param env NodeJS environment
+     * @param deferred Deferred promise
+     * @param reader Reader
+     * @param varid Variable id
+     * @param type Variable type
+     * @param slab Hyperslab
+     * @return Promise
+     */
+    Napi::Promise classic_read(Napi::Env env, Napi::Promise::Deferred deferred, const std::shared_ptr<ClassicReader> &reader,
+        int varid, int type, const Hyperslab &slab);
+
+}
+
+#endif
@@ -0,0 +1,337 @@
+#include <netcdf.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include "netcdf4-async.h"
+#include "Coalescer.h"
+#include "ResultCache.h"
+#include "ClassicReader.h"
+#include "ChunkEngine.h"
+
+namespace netcdf4async {
+
+bool coalesce_enabled = true;
+size_t coalesce_gap = 0;
+uint64_t coalesced_batches = 0;
+uint64_t coalesced_requests = 0;
+bool single_flight_enabled = true;
+bool single_flight_shared = false;
+uint64_t single_flight_hits = 0;
+
+/// @brief Bounding box may be at most this times larger than hyperslabs it serves
+const size_t max_coalesce_waste = 2;
+
+/// @brief Reads in flight by key
+static std::map<std::tuple<napi_env, int, int, int, std::vector<size_t>, std::vector<size_t>, std::vector<ptrdiff_t>>, HyperslabReadWorker *> inflight;
+/// @brief Guard for inflight registry, environments may live in different threads
+static std::mutex inflight_lock;
+
+HyperslabReadWorker::HyperslabReadWorker(Napi::Env &env, Napi::Promise::Deferred deferred, int ncid, int varid, int type, const Hyperslab &slab)
+	: AsyncPromiseWorker(env, deferred), ncid(ncid), varid(varid), type(type), slab(slab), members_len(0), status(NC_NOERR),
+	key(env, ncid, varid, type, slab.start, slab.count, slab.stride), registered(false), barrier(0),
+	cacheable(false), cache_generation(0) {
+	result.type = type;
+	result.len = slab.len;
+	result.value.v = NULL;
+}
+
+Napi::Promise HyperslabReadWorker::Read(Napi::Env env, Napi::Promise::Deferred deferred, int ncid, int varid, int type, const Hyperslab &slab, const FileToken &token) {
+	// Neither mapped nor cached reads pass executor, so closed file is checked first
+	if (token && *token) {
+		deferred.Reject(Napi::String::New(env, "File already closed"));
+		return deferred.Promise();
+	}
+	// Reads of mapped netCDF-3 files run in parallel, so they are neither cached nor merged
+	auto reader = ClassicReader::Find(ncid);
+	if (reader) {
+		return classic_read(env, deferred, reader, varid, type, slab);
+	}
+	ResultCache &cache = ResultCache::Instance();
+	bool cacheable = false;
+	uint64_t generation = 0;
+	if (cache.Enabled()) {
+		Item item;
+		item.type = type;
+		if (cache.Lookup(ncid, varid, slab, item)) {
+			deferred.Resolve(item2value(env, &item));
+			return deferred.Promise();
+		}
+		cacheable = cache.Generation(ncid, generation);
+	}
+	auto executor = find_executor(ncid);
+	Key key(env, ncid, varid, type, slab.start, slab.count, slab.stride);
+	if (single_flight_enabled && executor) {
+		std::lock_guard<std::mutex> lock(inflight_lock);
+		auto it = inflight.find(key);
+		if (it != inflight.end() && it->second->barrier == executor->Barriers()) {
+			it->second->waiters.push_back(deferred);
+			single_flight_hits++;
+			return deferred.Promise();
+		}
+	}
+	auto worker = new HyperslabReadWorker(env, deferred, ncid, varid, type, slab);
+	worker->cacheable = cacheable;
+	worker->cache_generation = generation;
+	if (single_flight_enabled && executor) {
+		std::lock_guard<std::mutex> lock(inflight_lock);
+		worker->barrier = executor->Barriers();
+		worker->registered = true;
+		inflight[key] = worker;
+	}
+	worker->Queue(ncid, token);
+	return deferred.Promise();
+}
+
+/**
+ * @brief Stop accepting identical reads. Called before results are delivered
+ */
+void HyperslabReadWorker::Unregister() {
+	if (!registered) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(inflight_lock);
+	auto it = inflight.find(key);
+	if (it != inflight.end() && it->second == this) {
+		inflight.erase(it);
+	}
+	registered = false;
+}
+
+HyperslabReadWorker::~HyperslabReadWorker() {
+	Unregister();
+	// Result of failed read is never handed to JS
+	if (result.value.v != NULL) {
+		releaseItem(&result);
+	}
+	for (auto follower : followers) {
+		delete follower;
+	}
+}
+
+/**
+ * @brief Check if other read could join bounding box
+ * Hyperslabs must overlap or be within coalesce_gap along every dimension, and
+ * new bounding box must not be much larger than hyperslabs it serves
+ * @param other Candidate
+ * @param start New bounding box start
+ * @param end New bounding box end
+ * @param volume New bounding box size in elements
+ * @return true if candidate could be merged
+ */
+bool HyperslabReadWorker::Mergeable(const HyperslabReadWorker *other, std::vector<size_t> &start, std::vector<size_t> &end, size_t &volume) const {
+	if (other->ncid != ncid || other->varid != varid || other->type != type ||
+		!other->slab.stride.empty() || other->slab.len == 0) {
+		return false;
+	}
+	volume = 1;
+	for (size_t i = 0; i < box_start.size(); i++) {
+		size_t other_end = other->slab.start[i] + other->slab.count[i];
+		if (other->slab.start[i] > box_end[i] + coalesce_gap || box_start[i] > other_end + coalesce_gap) {
+			return false;
+		}
+		start[i] = std::min(box_start[i], other->slab.start[i]);
+		end[i] = std::max(box_end[i], other_end);
+		volume *= end[i] - start[i];
+	}
+	return volume <= max_coalesce_waste * (members_len + other->slab.len);
+}
+
+/**
+ * @brief Take reads waiting right after this one
+ * Only consecutive reads are taken, so order with writes and other operations is kept
+ * @param queue Executor queue
+ */
+void HyperslabReadWorker::Absorb(std::deque<AsyncPromiseWorker *> &queue) {
+	if (!coalesce_enabled || type == NC_STRING || !slab.stride.empty() || slab.len == 0) {
+		return;
+	}
+	box_start = slab.start;
+	box_end.resize(slab.start.size());
+	for (size_t i = 0; i < slab.start.size(); i++) {
+		box_end[i] = slab.start[i] + slab.count[i];
+	}
+	members_len = slab.len;
+	std::vector<size_t> start(box_start.size());
+	std::vector<size_t> end(box_start.size());
+	while (!queue.empty()) {
+		HyperslabReadWorker *next = queue.front()->AsHyperslabRead();
+		size_t volume;
+		if (next == nullptr || !Mergeable(next, start, end, volume)) {
+			break;
+		}
+		queue.pop_front();
+		next->Detach();
+		followers.push_back(next);
+		box_start = start;
+		box_end = end;
+		members_len += next->slab.len;
+	}
+	if (!followers.empty()) {
+		coalesced_batches++;
+		coalesced_requests += followers.size();
+	}
+}
+
+/**
+ * @brief Copy own hyperslab out of bounding box, row by row along last dimension
+ * @param data Bounding box values
+ * @param box Bounding box
+ * @param type_size Size of value
+ */
+void HyperslabReadWorker::Extract(const uint8_t *data, const Hyperslab &box, size_t type_size) {
+	typedValue(&result);
+	uint8_t *out = static_cast<uint8_t *>(result.value.v);
+	size_t ndims = slab.start.size();
+	if (ndims == 0) {
+		memcpy(out, data, type_size);
+		return;
+	}
+	size_t row = slab.count[ndims - 1] * type_size;
+	size_t rows = slab.len / slab.count[ndims - 1];
+	std::vector<size_t> index(ndims - 1, 0);
+	for (size_t r = 0; r < rows; r++) {
+		size_t offset = 0;
+		for (size_t d = 0; d + 1 < ndims; d++) {
+			offset = offset * box.count[d] + slab.start[d] - box.start[d] + index[d];
+		}
+		offset = offset * box.count[ndims - 1] + slab.start[ndims - 1] - box.start[ndims - 1];
+		memcpy(out + r * row, data + offset * type_size, row);
+		for (size_t d = ndims - 1; d > 0; d--) {
+			if (++index[d - 1] < slab.count[d - 1]) {
+				break;
+			}
+			index[d - 1] = 0;
+		}
+	}
+}
+
+/**
+ * @brief Read own hyperslab
+ * Status is kept, so failure of one request does not affect other ones
+ */
+void HyperslabReadWorker::ReadOwn() {
+	typedValue(&result);
+	status = readHyperslab(ncid, varid, slab, result.value.v);
+}
+
+void HyperslabReadWorker::Execute() {
+	// Chunk engine releases lock while inflating chunks
+	std::unique_lock<std::mutex> lock(netcdf_lock());
+	if (followers.empty()) {
+		typedValue(&result);
+		if (!read_chunks(ncid, varid, type, slab, result.value.v, lock)) {
+			NC_CALL(readHyperslab(ncid, varid, slab, result.value.v));
+		}
+		return;
+	}
+	size_t type_size;
+	NC_CALL(nc_inq_type(ncid, type, NULL, &type_size));
+	Hyperslab box;
+	box.start = box_start;
+	box.len = 1;
+	for (size_t i = 0; i < box_start.size(); i++) {
+		box.count.push_back(box_end[i] - box_start[i]);
+		box.len *= box.count[i];
+	}
+	uint8_t *data = BufferPool::Instance().Allocate<uint8_t>(box.len * type_size);
+	if (read_chunks(ncid, varid, type, box, data, lock) || readHyperslab(ncid, varid, box, data) == NC_NOERR) {
+		Extract(data, box, type_size);
+		for (auto follower : followers) {
+			follower->Extract(data, box, type_size);
+		}
+	}
+	else {
+		// Some request is wrong, read each one separately to get its own result
+		ReadOwn();
+		for (auto follower : followers) {
+			follower->ReadOwn();
+		}
+	}
+	BufferPool::Instance().Release(data);
+}
+
+/**
+ * @brief Independent copy of read result
+ * Numbers and strings are immutable, so only TypedArray is copied
+ * @param env NodeJS environment
+ * @param value Result
+ * @return Napi::Value Copy
+ */
+static Napi::Value copy_value(Napi::Env env, Napi::Value value) {
+	if (!value.IsTypedArray()) {
+		return value;
+	}
+	Napi::TypedArray array = value.As<Napi::TypedArray>();
+	Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, array.ByteLength());
+	memcpy(buffer.Data(), static_cast<uint8_t *>(array.ArrayBuffer().Data()) + array.ByteOffset(), array.ByteLength());
+	napi_value copy;
+	napi_status status = napi_create_typedarray(env, array.TypedArrayType(), array.ElementLength(), buffer, 0, &copy);
+	if (status != napi_ok) {
+		throw Napi::Error::New(env);
+	}
+	return Napi::Value(env, copy);
+}
+
+/**
+ * @brief Resolve or reject promises of request and attached requests by read status
+ * @param env NodeJS environment
+ */
+void HyperslabReadWorker::Settle(Napi::Env env) {
+	Unregister();
+	std::vector<Napi::Promise::Deferred> deferreds(1, Deferred());
+	deferreds.insert(deferreds.end(), waiters.begin(), waiters.end());
+	if (status != NC_NOERR) {
+		Napi::Value error = Napi::Error::New(env, string_format("NetCDF4: %s", nc_strerror(status))).Value();
+		for (auto &deferred : deferreds) {
+			deferred.Reject(error);
+		}
+		return;
+	}
+	if (cacheable) {
+		ResultCache::Instance().Insert(ncid, cache_generation, varid, slab, result);
+	}
+	Napi::Value value;
+	try {
+		value = item2value(env, &result);
+	} catch (const Napi::Error &e) {
+		// item2value takes buffer even if it fails
+		result.value.v = NULL;
+		for (auto &deferred : deferreds) {
+			deferred.Reject(e.Value());
+		}
+		return;
+	}
+	result.value.v = NULL;
+	for (size_t i = 0; i < deferreds.size(); i++) {
+		try {
+			deferreds[i].Resolve(i == 0 || single_flight_shared ? value : copy_value(env, value));
+		} catch (const Napi::Error &e) {
+			deferreds[i].Reject(e.Value());
+		}
+	}
+}
+
+void HyperslabReadWorker::OnOK() {
+	Release();
+	for (auto follower : followers) {
+		follower->Settle(Env());
+	}
+	Settle(Env());
+}
+
+void HyperslabReadWorker::OnError(Napi::Error const &error) {
+	Unregister();
+	AsyncPromiseWorker::OnError(error);
+	for (auto &waiter : waiters) {
+		waiter.Reject(error.Value());
+	}
+	for (auto follower : followers) {
+		follower->Unregister();
+		follower->Deferred().Reject(error.Value());
+		for (auto &waiter : follower->waiters) {
+			waiter.Reject(error.Value());
+		}
+	}
+}
+
+}
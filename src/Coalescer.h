@@ -0,0 +1,95 @@
+#ifndef NETCDF4_COALESCER_H
+#define NETCDF4_COALESCER_H
+
+#include <napi.h>
+#include <vector>
+#include <tuple>
+#include "async.h"
+#include "Macros.h"
+
+namespace netcdf4async {
+
+    /// @brief Merge queued reads of neighbouring hyperslabs of one variable
+    extern bool coalesce_enabled;
+    /// @brief Max distance in elements, along any dimension, between merged hyperslabs
+    extern size_t coalesce_gap;
+    /// @brief Number of bounding reads which served more than one request
+    extern uint64_t coalesced_batches;
+    /// @brief Number of requests served by bounding read of another request
+    extern uint64_t coalesced_requests;
+    /// @brief Attach reads to identical read in flight instead of reading again
+    extern bool single_flight_enabled;
+    /// @brief Requests attached to identical read get the same TypedArray instead of own copy
+    extern bool single_flight_shared;
+    /// @brief Number of requests attached to identical read in flight
+    extern uint64_t single_flight_hits;
+
+    /**
+     * @brief Worker reading hyperslab of variable
+     * Before start worker takes reads of overlapping or close hyperslabs of the same variable
+     * waiting right after it in file executor queue. Then it reads their bounding box once
+     * and slices result of each request out of it.
+     * Identical reads (same variable, hyperslab and environment) posted while one is in flight,
+     * with no other operation of the file in between, are attached to it and share its result.
+     * With result cache enabled, cached results are returned without queueing worker at all.
+     */
+    class HyperslabReadWorker : public AsyncPromiseWorker {
+        public:
+            /// @brief Constructor
+            /// @param env NodeJS environment
+            /// @param deferred Deferred promise
+            /// @param ncid Group id
+            /// @param varid Variable id
+            /// @param type Variable type
+            /// @param slab Hyperslab to read, without stride
+            HyperslabReadWorker(Napi::Env &env, Napi::Promise::Deferred deferred, int ncid, int varid, int type, const Hyperslab &slab);
+            /// @brief Read hyperslab, attaching to identical read in flight if possible
+            /// @param env NodeJS environment
+            /// @param deferred Deferred promise
+            /// @param ncid Group id
+            /// @param varid Variable id
+            /// @param type Variable type
+            /// @param slab Hyperslab to read
+            /// @param token Closed flag of file, read is rejected if it is set
+            /// @return Promise
+            static Napi::Promise Read(Napi::Env env, Napi::Promise::Deferred deferred, int ncid, int varid, int type, const Hyperslab &slab, const FileToken &token);
+            /// @brief Destroy worker and requests it served
+            ~HyperslabReadWorker() override;
+            /// @brief Take mergeable reads from executor queue
+            /// @param queue Executor queue
+            void Absorb(std::deque<AsyncPromiseWorker *> &queue) override;
+            /// @brief Reject promises of worker and requests it served
+            /// @param error Error
+            void OnError(Napi::Error const &error) override;
+            HyperslabReadWorker *AsHyperslabRead() override { return this; };
+        protected:
+            void Execute() override;
+            void OnOK() override;
+        private:
+            bool Mergeable(const HyperslabReadWorker *other, std::vector<size_t> &start, std::vector<size_t> &end, size_t &volume) const;
+            void Extract(const uint8_t *data, const Hyperslab &box, size_t type_size);
+            void ReadOwn();
+            void Settle(Napi::Env env);
+            void Unregister();
+            typedef std::tuple<napi_env, int, int, int, std::vector<size_t>, std::vector<size_t>, std::vector<ptrdiff_t>> Key;
+            int ncid;
+            int varid;
+            int type;
+            Hyperslab slab;
+            Item result;
+            std::vector<HyperslabReadWorker *> followers;
+            std::vector<size_t> box_start;
+            std::vector<size_t> box_end;
+            size_t members_len;
+            int status;
+            Key key;
+            bool registered;
+            uint64_t barrier;
+            std::vector<Napi::Promise::Deferred> waiters;
+            bool cacheable;
+            uint64_t cache_generation;
+    };
+
+}
+
+#endif
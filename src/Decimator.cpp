@@ -0,0 +1,256 @@
+#include <netcdf.h>
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "netcdf4-async.h"
+#include "BufferPool.h"
+#include "Decimator.h"
+
+namespace netcdf4async {
+
+bool decimate_enabled = true;
+std::atomic<uint64_t> decimated_reads(0);
+std::atomic<uint64_t> strided_reads(0);
+
+/// @brief Cost of reading one value of strided hyperslab of contiguous variable by libnetcdf,
+/// in bytes of bounding box read in the same time
+const size_t strided_value_cost = 1024;
+/// @brief Bounding box of chunked variable may touch at most this times more chunks than strided hyperslab
+const size_t max_chunk_waste = 2;
+/// @brief Max size of part of bounding box read at once
+const size_t max_band_size = 64 * 1024 * 1024;
+
+/**
+ * @brief Copy every stride-th value one by one. Values may be unaligned
+ */
+template<class T> static void gather_values(uint8_t *dst, const uint8_t *src, size_t count, size_t stride) {
+	for (size_t i = 0; i < count; i++) {
+		T v;
+		memcpy(&v, src + i * stride * sizeof(T), sizeof(T));
+		memcpy(dst + i * sizeof(T), &v, sizeof(T));
+	}
+}
+
+static void gather_scalar(uint8_t *dst, const uint8_t *src, size_t count, size_t stride, size_t size) {
+	switch (size) {
+	case 1:
+		gather_values<uint8_t>(dst, src, count, stride);
+		break;
+	case 2:
+		gather_values<uint16_t>(dst, src, count, stride);
+		break;
+	case 4:
+		gather_values<uint32_t>(dst, src, count, stride);
+		break;
+	case 8:
+		gather_values<uint64_t>(dst, src, count, stride);
+		break;
+	default:
+		for (size_t i = 0; i < count; i++) {
+			memcpy(dst + i * size, src + i * stride * size, size);
+		}
+		break;
+	}
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NC_SIMD_GATHER 1
+/**
+ * @brief Gather 4 and 8 byte values with AVX2. Built for AVX2 regardless of compiler flags,
+ * used only if CPU supports it
+ * @return Number of values copied, the rest is left to scalar loop
+ */
+__attribute__((target("avx2")))
+static size_t gather_simd(uint8_t *dst, const uint8_t *src, size_t count, size_t stride, size_t size) {
+	// Indices of one block are relative to its first value
+	if ((size != 4 && size != 8) || stride > static_cast<size_t>(std::numeric_limits<int32_t>::max() / 8)) {
+		return 0;
+	}
+	int step = static_cast<int>(stride);
+	size_t done = 0;
+	if (size == 4) {
+		__m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(step));
+		for (; done + 8 <= count; done += 8) {
+			__m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int *>(src + done * stride * 4), index, 4);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + done * 4), v);
+		}
+	}
+	else {
+		__m128i index = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(step));
+		for (; done + 4 <= count; done += 4) {
+			__m256i v = _mm256_i32gather_epi64(reinterpret_cast<const long long *>(src + done * stride * 8), index, 8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + done * 8), v);
+		}
+	}
+	return done;
+}
+
+static bool simd_supported() {
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+}
+#endif
+
+void gather_strided(void *dst, const void *src, size_t count, size_t stride, size_t size) {
+	uint8_t *out = static_cast<uint8_t *>(dst);
+	const uint8_t *in = static_cast<const uint8_t *>(src);
+	if (stride == 1) {
+		memcpy(out, in, count * size);
+		return;
+	}
+	size_t done = 0;
+#ifdef NC_SIMD_GATHER
+	if (simd_supported()) {
+		done = gather_simd(out, in, count, stride, size);
+	}
+#endif
+	gather_scalar(out + done * size, in + done * stride * size, count - done, stride, size);
+}
+
+/**
+ * @brief Copy strided hyperslab out of its bounding box, row by row along last dimension
+ * @param out Hyperslab values
+ * @param box Bounding box values
+ * @param count Hyperslab shape
+ * @param box_count Bounding box shape
+ * @param stride Hyperslab stride
+ * @param type_size Size of value
+ */
+static void decimate(uint8_t *out, const uint8_t *box, const std::vector<size_t> &count, const std::vector<size_t> &box_count,
+	const std::vector<ptrdiff_t> &stride, size_t type_size) {
+	size_t last = count.size() - 1;
+	std::vector<size_t> pitch(count.size(), 1);
+	for (size_t d = last; d > 0; d--) {
+		pitch[d - 1] = pitch[d] * box_count[d];
+	}
+	size_t rows = 1;
+	for (size_t d = 0; d < last; d++) {
+		rows *= count[d];
+	}
+	size_t row = count[last] * type_size;
+	std::vector<size_t> index(last, 0);
+	for (size_t r = 0; r < rows; r++) {
+		size_t offset = 0;
+		for (size_t d = 0; d < last; d++) {
+			offset += index[d] * static_cast<size_t>(stride[d]) * pitch[d];
+		}
+		gather_strided(out + r * row, box + offset * type_size, count[last], static_cast<size_t>(stride[last]), type_size);
+		for (size_t d = last; d > 0; d--) {
+			if (++index[d - 1] < count[d - 1]) {
+				break;
+			}
+			index[d - 1] = 0;
+		}
+	}
+}
+
+/**
+ * @brief Decide if bounding box of strided hyperslab should be read
+ * Chunked variables: box must not touch much more chunks than hyperslab, as chunks are read whole anyway.
+ * Contiguous variables: box must not be much larger than cost of reading hyperslab value by value
+ * @param ncid Group id
+ * @param varid Variable id
+ * @param slab Hyperslab
+ * @param box_count Bounding box shape
+ * @param type_size Size of value
+ * @return true if bounding box read is cheaper
+ */
+static bool box_cheaper(int ncid, int varid, const Hyperslab &slab, const std::vector<size_t> &box_count, size_t type_size) {
+	size_t ndims = slab.count.size();
+	int storage;
+	std::vector<size_t> chunks(ndims);
+	if (nc_inq_var_chunking(ncid, varid, &storage, chunks.data()) != NC_NOERR) {
+		return false;
+	}
+	if (storage == NC_CHUNKED) {
+		double waste = 1;
+		for (size_t d = 0; d < ndims; d++) {
+			if (chunks[d] == 0) {
+				return false;
+			}
+			size_t box_chunks = (slab.start[d] + box_count[d] - 1) / chunks[d] - slab.start[d] / chunks[d] + 1;
+			// Gaps shorter than chunk do not skip any chunk
+			size_t slab_chunks = static_cast<size_t>(slab.stride[d]) >= chunks[d] ? slab.count[d] : box_chunks;
+			waste *= static_cast<double>(box_chunks) / static_cast<double>(slab_chunks);
+		}
+		return waste <= max_chunk_waste;
+	}
+	double box_bytes = static_cast<double>(type_size);
+	for (auto len : box_count) {
+		box_bytes *= static_cast<double>(len);
+	}
+	return box_bytes <= static_cast<double>(slab.len) * strided_value_cost;
+}
+
+/**
+ * @brief Read bounding box in bands along first dimension and decimate them
+ * @return NetCDF status of first failed band read
+ */
+static int read_box(int ncid, int varid, const Hyperslab &slab, const std::vector<size_t> &box_count, size_t type_size, void *data) {
+	size_t ndims = slab.count.size();
+	size_t stride = static_cast<size_t>(slab.stride[0]);
+	size_t plane = type_size;
+	size_t out_plane = type_size;
+	for (size_t d = 1; d < ndims; d++) {
+		plane *= box_count[d];
+		out_plane *= slab.count[d];
+	}
+	size_t band_rows = std::min(slab.count[0], std::max<size_t>(1, max_band_size / (plane * stride)));
+	size_t band_size = ((band_rows - 1) * stride + 1) * plane;
+	uint8_t *band = BufferPool::Instance().Allocate<uint8_t>(band_size);
+	Hyperslab part;
+	part.start = slab.start;
+	part.count = box_count;
+	std::vector<size_t> out_count = slab.count;
+	uint8_t *out = static_cast<uint8_t *>(data);
+	int status = NC_NOERR;
+	for (size_t r = 0; r < slab.count[0] && status == NC_NOERR; r += band_rows) {
+		out_count[0] = std::min(band_rows, slab.count[0] - r);
+		part.start[0] = slab.start[0] + r * stride;
+		part.count[0] = (out_count[0] - 1) * stride + 1;
+		status = nc_get_vara(ncid, varid, part.start.data(), part.count.data(), band);
+		if (status == NC_NOERR) {
+			decimate(out + r * out_plane, band, out_count, part.count, slab.stride, type_size);
+		}
+	}
+	BufferPool::Instance().Release(band);
+	return status;
+}
+
+int read_strided(int ncid, int varid, const Hyperslab &slab, void *data) {
+	bool plan = decimate_enabled && slab.len > 0;
+	bool unit = true;
+	for (size_t d = 0; d < slab.stride.size() && plan; d++) {
+		plan = slab.stride[d] > 0;
+		unit = unit && slab.stride[d] == 1;
+	}
+	if (plan && unit) {
+		return nc_get_vara(ncid, varid, slab.start.data(), slab.count.data(), data);
+	}
+	nc_type type;
+	size_t type_size = 0;
+	// Strings are allocated by libnetcdf, other user types are left as they are
+	plan = plan && nc_inq_vartype(ncid, varid, &type) == NC_NOERR && type != NC_STRING && type <= NC_MAX_ATOMIC_TYPE &&
+		nc_inq_type(ncid, type, NULL, &type_size) == NC_NOERR;
+	std::vector<size_t> box_count(slab.count.size());
+	size_t plane = 1;
+	for (size_t d = 0; d < slab.count.size() && plan; d++) {
+		box_count[d] = (slab.count[d] - 1) * static_cast<size_t>(slab.stride[d]) + 1;
+		plane *= d > 0 ? box_count[d] : 1;
+	}
+	// Single plane of box must fit into band
+	plan = plan && plane * type_size <= max_band_size && box_cheaper(ncid, varid, slab, box_count, type_size);
+	if (plan && read_box(ncid, varid, slab, box_count, type_size, data) == NC_NOERR) {
+		decimated_reads++;
+		return NC_NOERR;
+	}
+	// Wrong hyperslabs get the same error as before
+	strided_reads++;
+	return nc_get_vars(ncid, varid, slab.start.data(), slab.count.data(), slab.stride.data(), data);
+}
+
+}
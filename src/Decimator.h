@@ -0,0 +1,45 @@
+#ifndef NETCDF4_DECIMATOR_H
+#define NETCDF4_DECIMATOR_H
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include "Macros.h"
+
+namespace netcdf4async {
+
+    /// @brief Strided reads may be done as bounding box reads with decimation in memory
+    extern bool decimate_enabled;
+    /// @brief Number of strided reads done as bounding box reads
+    extern std::atomic<uint64_t> decimated_reads;
+    /// @brief Number of strided reads left to nc_get_vars
+    extern std::atomic<uint64_t> strided_reads;
+
+    /**
+     * @brief Copy every stride-th value
+     * Uses SIMD gather where CPU supports it
+     * @param dst Destination, count values
+     * @param src Source, (count - 1) * stride + 1 values
+     * @param count Number of values
+     * @param stride Distance between values in source, in values
+     * @param size Size of value
+     */
+    void gather_strided(void *dst, const void *src, size_t count, size_t stride, size_t size);
+
+    /**
+     * @brief Read strided hyperslab. Must be called with netcdf lock held
+     * libnetcdf reads strided hyperslabs value by value or row by row. When chunk layout
+     * (or value size for contiguous variables) shows what reading the bounding box is cheaper,
+     * box is read with nc_get_vara in bands of limited size and decimated in memory.
+     * Otherwise, and if box read fails, hyperslab is read with nc_get_vars, so result and errors do not change
+     * @param ncid Group id
+     * @param varid Variable id
+     * @param slab Hyperslab with stride
+     * @param data Destination
+     * @return NetCDF status
+     */
+    int read_strided(int ncid, int varid, const Hyperslab &slab, void *data);
+
+}
+
+#endif
@@ -2,9 +2,19 @@
 #include <mutex>
 #include <shared_mutex>
 #include <netcdf.h>
+#include <netcdf_mem.h>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
 #include "netcdf4-async.h"
 #include "async.h"
+#include "ResultCache.h"
+#include "Schema.h"
+#include "AdaptiveCache.h"
+#include "MetadataIndex.h"
+#include "HandlePool.h"
+#include "ClassicReader.h"
+#include "Macros.h"
 
 namespace netcdf4async {
 
@@ -22,21 +32,179 @@ struct NCFile_result
 	std::string group_name;
 	/// @brief Last operation status
 	int status;
+	/// @brief File was opened from metadata index, real open is postponed
+	bool deferred;
+	/// @brief Handle is shared through handle pool
+	bool pooled;
 };
 
-std::shared_timed_mutex open_close;
-
+/**
+ * @brief Object found by full path
+ * 
+ */
+struct NCPath_result
+{
+	/// @brief What was found
+	enum { GROUP, VARIABLE, DIMENSION } kind;
+	/// @brief Group, variable or dimension id
+	int id;
+	/// @brief Group which holds variable or dimension
+	int parent_id;
+	/// @brief Name of found object
+	std::string name;
+	/// @brief Variable type
+	nc_type type;
+	/// @brief Number of variable dimensions
+	int ndims;
+	/// @brief Dimension length
+	size_t len;
+};
 
 Napi::FunctionReference File::constructor;
 
+/**
+ * @brief Queue close of file after its outstanding operations
+ * File is marked as closing at once, so operations posted later are rejected.
+ * Executor stays registered in this state until file id is reused
+ * @param env NodeJS environment
+ * @param deferred Deferred promise resolved to `{id, status}`
+ * @param id NetCDF file id
+ * @param executor File executor
+ * @param memory Buffer file was opened from, kept until file is closed
+ */
+static void queue_close(Napi::Env env, Napi::Promise::Deferred deferred, int id, const std::shared_ptr<NCExecutor> &executor,
+	const std::shared_ptr<Napi::ObjectReference> &memory) {
+	ResultCache::Instance().UnregisterFile(id);
+	SchemaRegistry::Instance().Remove(id);
+	AdaptiveCacheRegistry::Instance().Remove(id);
+	ClassicReader::Detach(id);
+	auto worker = new NCAsyncWorker<NCFile_result>(
+		env,
+		deferred,
+		[id] (const NCAsyncWorker<NCFile_result>* worker) {
+			static NCFile_result result;
+			result.id=id;
+			// Closes placeholder if file opened from metadata index was never used
+			result.status=nc_close(id);
+			return result;
+		},
+		[memory] (Napi::Env env,NCFile_result result)  {
+			Napi::Object obj=Napi::Object::New(env);
+			obj.Set("id",Napi::Number::New(env,result.id));
+			obj.Set("status",Napi::Number::New(env,result.status));
+			return obj;
+		}
+	);
+	worker->KeepDeferred();
+	worker->Queue(id);
+	executor->SetState(NCExecutor::CLOSING);
+}
+
+/// @brief Name of files opened from or created in memory
+static const char *memory_file_name = "<memory>";
+
+/**
+ * @brief Memory of in-memory file taken from library on close
+ */
+struct NCMemory_result
+{
+	/// @brief File id
+	int id;
+	/// @brief File contents, owned by receiver. NULL if file was opened from Buffer without copy
+	void *memory;
+	/// @brief Size of contents
+	size_t size;
+};
+
+/**
+ * @brief Creation mode flags of format name
+ * @param format_arg Format name
+ * @param open_format Mode flags
+ * @return false if format is unknown
+ */
+static bool parse_format(const std::string &format_arg, int &open_format) {
+	if (format_arg == "classic") {
+		open_format = 0;
+	} else if (format_arg == "classic64") {
+		open_format = NC_64BIT_OFFSET;
+	} else if (format_arg == "netcdf4") {
+		open_format = NC_NETCDF4;
+	} else if (format_arg == "netcdf4classic") {
+		open_format = NC_NETCDF4 | NC_CLASSIC_MODEL;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Open or create file with its own chunk cache settings
+ * Chunk cache of opened file is taken from library-wide settings, so set them
+ * only for this open. It is safe as all libnetcdf calls are serialized
+ * @return NetCDF status
+ */
+static int open_file(const std::string &name, int mode, bool create, bool chunk_cache_set, const ChunkCache &chunk_cache, int *id) {
+	size_t old_size, old_nelems;
+	float old_preemption;
+	int retval;
+	if (chunk_cache_set) {
+		if ((retval = nc_get_chunk_cache(&old_size, &old_nelems, &old_preemption)) != NC_NOERR ||
+			(retval = nc_set_chunk_cache(
+				chunk_cache.has_size ? chunk_cache.size : old_size,
+				chunk_cache.has_nelems ? chunk_cache.nelems : old_nelems,
+				chunk_cache.has_preemption ? chunk_cache.preemption : old_preemption
+			)) != NC_NOERR) {
+			return retval;
+		}
+	}
+	if (create) {
+		retval = nc_create(name.c_str(), mode, id);
+	}
+	else {
+		retval = nc_open(name.c_str(), mode, id);
+	}
+	if (chunk_cache_set) {
+		nc_set_chunk_cache(old_size, old_nelems, old_preemption);
+	}
+	return retval;
+}
+
 /**
  * @brief Destroy the File:: File object
  * Destroy file and close netcdf file (if not closed yet)
  */
 File::~File() {
+	// Groups and variables may outlive file object
+	*token=true;
+	if (pooled) {
+		// Handle is closed by handle pool when it is evicted
+		if (!closed) {
+			HandlePool::Instance().Release(id);
+			try {
+				HandlePool::Instance().Evict(Env());
+			} catch (...) {
+				// Environment is being torn down, handle is evicted on next close
+			}
+		}
+		return;
+	}
+	if (!closed && executor && !executor->Idle()) {
+		// Operations of file are still in progress, so close after them instead of blocking main thread
+		try {
+			queue_close(Env(), Napi::Promise::Deferred::New(Env()), id, executor, memory);
+			return;
+		} catch (...) {
+			// Environment is being torn down, close at once
+		}
+	}
 	if (!closed) {
-		std::unique_lock<std::shared_timed_mutex> lock(open_close);
+		ResultCache::Instance().UnregisterFile(id);
+		SchemaRegistry::Instance().Remove(id);
+		AdaptiveCacheRegistry::Instance().Remove(id);
+		ClassicReader::Detach(id);
+		std::lock_guard<std::mutex> lock(netcdf_lock());
 		nc_close(id);
+		executor->SetState(NCExecutor::CLOSING);
 	}
 }
 
@@ -74,8 +242,12 @@ void File::Init(Napi::Env env) {
 				InstanceMethod("sync", &File::Sync), 
 				InstanceMethod("close", &File::Close),
 				InstanceMethod("dataMode", &File::DataMode),
+				InstanceMethod("get", &File::Get),
+				InstanceMethod("describe", &File::Describe),
+				InstanceMethod("toBuffer", &File::ToBuffer),
 				InstanceAccessor<&File::GetName>("name"),
 				InstanceAccessor<&File::IsClosed>("closed"),
+				InstanceAccessor<&File::IsDefineMode>("defineMode"),
 				InstanceAccessor<&File::GetFormat>("format"),
 				InstanceMethod("inspect", &File::Inspect)
 			}
@@ -112,6 +284,15 @@ File::File(const Napi::CallbackInfo &info) : Napi::ObjectWrap<File>(info) {
 //	Napi::Object group = info[3].As<Napi::Object>();
 //	this->Value().Set("root", group);
 	closed=false;
+	token=std::make_shared<bool>(false);
+	pooled=false;
+	in_memory=false;
+	// Files sharing pooled handle share its executor too
+	executor=find_executor(id);
+	if (!executor || executor->GetState() == NCExecutor::CLOSING) {
+		executor=register_executor(id);
+	}
+	ResultCache::Instance().RegisterFile(id, name, mode != "r");
 }
 
 /**
@@ -128,12 +309,21 @@ File::File(
 		int id,std::string name,std::string mode,int format
 	) : Napi::ObjectWrap<File>(info),id(id),name(name),mode(mode),format(format) {
 	closed=false;
+	token=std::make_shared<bool>(false);
+	pooled=false;
+	in_memory=false;
+	// Files sharing pooled handle share its executor too
+	executor=find_executor(id);
+	if (!executor || executor->GetState() == NCExecutor::CLOSING) {
+		executor=register_executor(id);
+	}
+	ResultCache::Instance().RegisterFile(id, name, mode != "r");
 }
 
 
 void File::createDefaultGroup(Napi::Env env,std::string name) {
 	// printf("Default group=%s\n",name.c_str());
-	this->Value().Set("root",Group::Build(env,id,name));
+	this->Value().Set("root",Group::Build(env,id,name,token));
 }
 
 
@@ -157,21 +347,69 @@ Napi::Value File::Open(const Napi::CallbackInfo& info) {
 	Napi::Env env = info.Env();
 
 	if (info.Length() > 2 && !(info[2].IsUndefined() || info[2].IsNull())) {
-		std::string format_arg = info[2].As<Napi::String>();
-		if (format_arg == "classic") {
-			open_format = 0;
-		} else if (format_arg == "classic64") {
-			open_format = NC_64BIT_OFFSET;
-		} else if (format_arg == "netcdf4") {
-			open_format = NC_NETCDF4;
-		} else if (format_arg == "netcdf4classic") {
-			open_format = NC_NETCDF4 | NC_CLASSIC_MODEL;
-		} else {
+		if (!parse_format(info[2].As<Napi::String>(), open_format)) {
             deferred.Reject(Napi::String::New(info.Env(), "NetCDF4: Unknown file format"));
     		return deferred.Promise();
 		}
 	}
 
+	bool chunk_cache_set = false;
+	bool load_schema = true;
+	std::string index;
+	int storage = 0;
+	bool native_reader = false;
+	bool reader_views = false;
+	ChunkCache chunk_cache;
+	if (info.Length() > 3 && !(info[3].IsUndefined() || info[3].IsNull())) {
+		if (!info[3].IsObject()) {
+			deferred.Reject(Napi::String::New(info.Env(), "NetCDF4: Expecting an object with open options"));
+			return deferred.Promise();
+		}
+		Napi::Value schema_arg = info[3].As<Napi::Object>().Get("schema");
+		if (!schema_arg.IsUndefined()) {
+			load_schema = schema_arg.ToBoolean().Value();
+		}
+		Napi::Value index_arg = info[3].As<Napi::Object>().Get("index");
+		if (index_arg.IsString()) {
+			index = metadata_index_path(name, index_arg.As<Napi::String>().Utf8Value());
+		}
+		else if (index_arg.ToBoolean().Value()) {
+			index = metadata_index_path(name, "");
+		}
+		Napi::Object options = info[3].As<Napi::Object>();
+		if (options.Get("diskless").ToBoolean().Value()) {
+			storage |= NC_DISKLESS;
+		}
+		if (options.Get("mmap").ToBoolean().Value()) {
+			// libnetcdf keeps classic files in memory mapped file, it works on top of diskless mode
+			storage |= NC_DISKLESS | NC_MMAP;
+		}
+		if (options.Get("persist").ToBoolean().Value()) {
+#ifdef NC_PERSIST
+			if (storage == 0) {
+				deferred.Reject(Napi::String::New(info.Env(), "NetCDF4: persist requires diskless or mmap option"));
+				return deferred.Promise();
+			}
+			storage |= NC_PERSIST;
+#else
+			deferred.Reject(Napi::String::New(info.Env(), "NetCDF4: persist is not supported by libnetcdf"));
+			return deferred.Promise();
+#endif
+		}
+		Napi::Value reader_arg = options.Get("nativeReader");
+		native_reader = reader_arg.ToBoolean().Value();
+		reader_views = reader_arg.IsString() && reader_arg.As<Napi::String>().Utf8Value() == "view";
+		Napi::Value cache_arg = info[3].As<Napi::Object>().Get("chunkCache");
+		if (!cache_arg.IsUndefined()) {
+			std::string error;
+			if (!parseChunkCache(cache_arg, chunk_cache, error)) {
+				deferred.Reject(Napi::String::New(info.Env(), "NetCDF4: " + error));
+				return deferred.Promise();
+			}
+			chunk_cache_set = true;
+		}
+	}
+
 	int mode=0;
 	bool create=false;
 	if (mode_arg == "r") {
@@ -188,39 +426,279 @@ Napi::Value File::Open(const Napi::CallbackInfo& info) {
 		deferred.Reject(Napi::String::New(info.Env(), "NetCDF4: Unknown file mode"));
 		return deferred.Promise();
 	}
+	if ((storage & NC_MMAP) && create && (open_format & NC_NETCDF4)) {
+		deferred.Reject(Napi::String::New(info.Env(), "NetCDF4: mmap is supported for classic files only"));
+		return deferred.Promise();
+	}
+	// Index describes file as it is on disk, so it is used only for read only files with schema
+	if ((mode & NC_WRITE) || create || !load_schema) {
+		index.clear();
+	}
+	// Native reader maps file as it is on disk, so file must not change
+	if (mode != NC_NOWRITE || storage != 0) {
+		native_reader = false;
+	}
+	// Handle with own chunk cache, storage or reader is not shared
+	bool pool = mode == NC_NOWRITE && storage == 0 && !chunk_cache_set && !native_reader && HandlePool::Instance().Enabled();
+	mode |= storage;
+	HandlePool::Instance().Evict(env);
 
 
 	(new NCAsyncWorker<NCFile_result>(
 		env,
 		deferred,
-		[name,mode,create] (const NCAsyncWorker<NCFile_result>* worker) {
+		[name,mode,create,chunk_cache_set,chunk_cache,load_schema,index,pool,native_reader,reader_views] (const NCAsyncWorker<NCFile_result>* worker) {
 			static NCFile_result result;
-			std::unique_lock<std::shared_timed_mutex> lock(open_close);
+			std::string pool_key;
+			result.deferred=false;
+			result.pooled=false;
+			if (pool && HandlePool::Key(name, load_schema, pool_key) &&
+				HandlePool::Instance().Acquire(pool_key, result.id, result.format, result.group_name)) {
+				result.pooled=true;
+				return result;
+			}
+			result.deferred=!index.empty() && open_from_index(name, index, result.id, result.format, result.group_name);
+			if (!result.deferred) {
+				NC_CALL(open_file(name, mode, create, chunk_cache_set, chunk_cache, &result.id));
+				NC_CALL(nc_inq_format_extended(result.id,&result.format,NULL));
+				char varName[NC_MAX_NAME + 1];
+				NC_CALL(nc_inq_grpname(result.id, varName));
+				result.group_name=std::string(varName);
+				if (load_schema) {
+					// File without schema is still usable through async getters
+					if (SchemaRegistry::Instance().Load(result.id) == NC_NOERR && !index.empty()) {
+						write_metadata_index(name, index, result.id, result.format);
+					}
+				}
+			}
+			if (!pool_key.empty()) {
+				result.pooled=HandlePool::Instance().Add(pool_key, result.id, result.format, result.group_name);
+			}
+			if (native_reader) {
+				// Files of other formats are read through libnetcdf as usual
+				auto reader=ClassicReader::Open(name, reader_views);
+				if (reader) {
+					ClassicReader::Attach(result.id, reader);
+				}
+			}
+			return result;
+			// this->format=i;
+		},
+		[name,mode,mode_arg,create,chunk_cache_set,chunk_cache] (Napi::Env env,NCFile_result result)  {
+			auto file=File::Build(env,result.id,name,mode_arg,result.format);
+			void* native;
+			napi_unwrap(env,file,&native);
+			// std::unique_ptr<File> file=std::unique_ptr<File>(static_cast<File *>(native));
+			File* file_native=static_cast<File *>(native);
+			file_native->createDefaultGroup(env,result.group_name);
+			file_native->pooled=result.pooled;
 			if (create) {
-				NC_CALL(nc_create(name.c_str(), mode, &result.id));
+				file_native->executor->SetState(NCExecutor::DEFINE);
+			}
+			if (result.deferred) {
+				// Schema getters are served from index, file itself is opened by first other operation
+				file_native->executor->Defer([id=result.id,name,mode,chunk_cache_set,chunk_cache] () {
+					replace_placeholder(id, [&] (int *real) {
+						return open_file(name, mode, false, chunk_cache_set, chunk_cache, real);
+					});
+				});
+			}
+			return file;
+		}
+		
+	))->Queue();
+
+	return deferred.Promise();
+}
+
+/**
+ * @brief Async open netCDF file held in Buffer
+ * Read only files use Buffer memory without copy, Buffer is kept until file is closed.
+ * Writable files work on a copy owned by libnetcdf, changed contents are returned by `toBuffer()`
+ * @param info NodeJS params: Buffer, options `{mode, schema}`
+ * @return Napi::Value Deferred promise object
+ */
+Napi::Value File::OpenBuffer(const Napi::CallbackInfo& info) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+	if (info.Length() < 1 || !info[0].IsBuffer()) {
+		deferred.Reject(Napi::String::New(env, "Expecting a Buffer"));
+		return deferred.Promise();
+	}
+	std::string mode_arg = "r";
+	bool load_schema = true;
+	if (info.Length() > 1 && info[1].IsObject()) {
+		Napi::Object options = info[1].As<Napi::Object>();
+		if (options.Get("mode").IsString()) {
+			mode_arg = options.Get("mode").As<Napi::String>().Utf8Value();
+		}
+		if (!options.Get("schema").IsUndefined()) {
+			load_schema = options.Get("schema").ToBoolean().Value();
+		}
+	}
+	if (mode_arg != "r" && mode_arg != "w") {
+		deferred.Reject(Napi::String::New(env, "NetCDF4: Unknown file mode"));
+		return deferred.Promise();
+	}
+	bool writable = mode_arg == "w";
+	Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+	auto memory = std::make_shared<Napi::ObjectReference>(Napi::Persistent(buffer.As<Napi::Object>()));
+	(new NCAsyncWorker<NCFile_result>(
+		env,
+		deferred,
+		[data=buffer.Data(), size=buffer.Length(), writable, load_schema] (const NCAsyncWorker<NCFile_result>* worker) {
+			static NCFile_result result;
+			if (writable) {
+				NC_memio memio;
+				memio.size=size;
+				memio.memory=malloc(size);
+				memio.flags=0;
+				if (memio.memory == NULL) {
+					throw std::runtime_error("NetCDF4: Not enough memory");
+				}
+				memcpy(memio.memory, data, size);
+				// libnetcdf owns copy from now on, it is freed on close
+				NC_CALL(nc_open_memio(memory_file_name, NC_WRITE, &memio, &result.id));
 			}
 			else {
-				NC_CALL(nc_open(name.c_str(), mode, &result.id));
+				NC_CALL(nc_open_mem(memory_file_name, NC_NOWRITE, size, data, &result.id));
 			}
 			NC_CALL(nc_inq_format_extended(result.id,&result.format,NULL));
 			char varName[NC_MAX_NAME + 1];
 			NC_CALL(nc_inq_grpname(result.id, varName));
 			result.group_name=std::string(varName);
+			if (load_schema) {
+				SchemaRegistry::Instance().Load(result.id);
+			}
 			return result;
-			// this->format=i;
 		},
-		[name,mode_arg] (Napi::Env env,NCFile_result result)  {
-			auto file=File::Build(env,result.id,name,mode_arg,result.format);
+		[memory, mode_arg, writable] (Napi::Env env,NCFile_result result) {
+			auto file=File::Build(env,result.id,memory_file_name,mode_arg,result.format);
 			void* native;
 			napi_unwrap(env,file,&native);
-			// std::unique_ptr<File> file=std::unique_ptr<File>(static_cast<File *>(native));
 			File* file_native=static_cast<File *>(native);
 			file_native->createDefaultGroup(env,result.group_name);
+			file_native->in_memory=true;
+			if (!writable) {
+				file_native->memory=memory;
+			}
 			return file;
 		}
-		
 	))->Queue();
+	return deferred.Promise();
+}
 
+/**
+ * @brief Async create netCDF file in memory
+ * File is never written to disk, its contents are returned by `toBuffer()`
+ * @param info NodeJS params: format, options `{initialSize}`
+ * @return Napi::Value Deferred promise object
+ */
+Napi::Value File::CreateBuffer(const Napi::CallbackInfo& info) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+	int open_format = NC_NETCDF4;
+	if (info.Length() > 0 && !(info[0].IsUndefined() || info[0].IsNull())) {
+		if (!parse_format(info[0].ToString().Utf8Value(), open_format)) {
+			deferred.Reject(Napi::String::New(env, "NetCDF4: Unknown file format"));
+			return deferred.Promise();
+		}
+	}
+	size_t initial_size = 0;
+	if (info.Length() > 1 && info[1].IsObject()) {
+		Napi::Value size_arg = info[1].As<Napi::Object>().Get("initialSize");
+		if (!size_arg.IsUndefined()) {
+			if (!size_arg.IsNumber() || size_arg.As<Napi::Number>().Int64Value() < 0) {
+				deferred.Reject(Napi::String::New(env, "NetCDF4: initialSize must be a non-negative integer"));
+				return deferred.Promise();
+			}
+			initial_size = static_cast<size_t>(size_arg.As<Napi::Number>().Int64Value());
+		}
+	}
+	(new NCAsyncWorker<NCFile_result>(
+		env,
+		deferred,
+		[open_format, initial_size] (const NCAsyncWorker<NCFile_result>* worker) {
+			static NCFile_result result;
+			NC_CALL(nc_create_mem(memory_file_name, open_format, initial_size, &result.id));
+			NC_CALL(nc_inq_format_extended(result.id,&result.format,NULL));
+			char varName[NC_MAX_NAME + 1];
+			NC_CALL(nc_inq_grpname(result.id, varName));
+			result.group_name=std::string(varName);
+			SchemaRegistry::Instance().Load(result.id);
+			return result;
+		},
+		[] (Napi::Env env,NCFile_result result) {
+			auto file=File::Build(env,result.id,memory_file_name,"c",result.format);
+			void* native;
+			napi_unwrap(env,file,&native);
+			File* file_native=static_cast<File *>(native);
+			file_native->createDefaultGroup(env,result.group_name);
+			file_native->in_memory=true;
+			file_native->executor->SetState(NCExecutor::DEFINE);
+			return file;
+		}
+	))->Queue();
+	return deferred.Promise();
+}
+
+/**
+ * @brief Close in-memory file and return its contents
+ * Contents are handed to Buffer without copy where runtime allows external buffers.
+ * Read only file opened from Buffer resolves to that Buffer
+ * @param info NodeJS params
+ * @return Napi::Value Deferred promise resolved to Buffer
+ */
+Napi::Value File::ToBuffer(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+	if (this->closed) {
+		deferred.Reject(Napi::String::New(env, "File already closed"));
+		return deferred.Promise();
+	}
+	if (!this->in_memory) {
+		deferred.Reject(Napi::String::New(env, "NetCDF4: File is not in memory"));
+		return deferred.Promise();
+	}
+	this->closed=true;
+	*this->token=true;
+	this->Value().Delete("root");
+	ResultCache::Instance().UnregisterFile(this->id);
+	SchemaRegistry::Instance().Remove(this->id);
+	AdaptiveCacheRegistry::Instance().Remove(this->id);
+	auto worker = new NCAsyncWorker<NCMemory_result>(
+		env,
+		deferred,
+		[id=this->id, borrowed=static_cast<bool>(this->memory)] (const NCAsyncWorker<NCMemory_result>* worker) {
+			NCMemory_result result;
+			result.id=id;
+			result.memory=NULL;
+			result.size=0;
+			if (borrowed) {
+				NC_CALL(nc_close(id));
+				return result;
+			}
+			NC_memio memio;
+			NC_CALL(nc_close_memio(id, &memio));
+			result.memory=memio.memory;
+			result.size=memio.size;
+			return result;
+		},
+		[memory=this->memory] (Napi::Env env, NCMemory_result result) -> Napi::Value {
+			if (memory) {
+				return memory->Value();
+			}
+			if (external_buffers) {
+				return Napi::Buffer<uint8_t>::New(env, static_cast<uint8_t *>(result.memory), result.size,
+					[] (Napi::Env env, uint8_t *data) { free(data); });
+			}
+			Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, static_cast<uint8_t *>(result.memory), result.size);
+			free(result.memory);
+			return buffer;
+		}
+	);
+	worker->Queue(this->id);
+	this->executor->SetState(NCExecutor::CLOSING);
 	return deferred.Promise();
 }
 
@@ -245,12 +723,13 @@ Napi::Value File::DataMode(const Napi::CallbackInfo &info) {
 				return result;
 				// this->format=i;
 			},
-			[] (Napi::Env env,NCFile_result result)  {
+			[executor=this->executor] (Napi::Env env,NCFile_result result)  {
+				executor->SetState(NCExecutor::DATA);
 				return Napi::Number::New(env,result.id);
 			//	deferred.Resolve();
 			}
 			
-		))->Queue();
+		))->Queue(id);
 	}
 	else {
 		deferred.Reject(Napi::String::New(info.Env(), "File already closed"));
@@ -258,6 +737,134 @@ Napi::Value File::DataMode(const Napi::CallbackInfo &info) {
 	return deferred.Promise();
 }
 
+/**
+ * @brief Resolve full path like `/forcing/era5/t2m` in one worker
+ * Last component is looked up as variable, then as group, then as dimension visible in its group.
+ * All lookups use name indexes of libnetcdf, so they do not depend on number of objects
+ * @param info NodeJS params
+ * @return Napi::Value Deferred promise resolved to Variable, Group or `{name:length}` of dimension
+ */
+Napi::Value File::Get(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+	if (this->closed) {
+		deferred.Reject(Napi::String::New(env, "File already closed"));
+		return deferred.Promise();
+	}
+	if (info.Length() < 1 || !info[0].IsString()) {
+		deferred.Reject(Napi::String::New(env, "Expecting a path"));
+		return deferred.Promise();
+	}
+	std::string path = info[0].As<Napi::String>().Utf8Value();
+	(new NCAsyncWorker<NCPath_result>(
+		env,
+		deferred,
+		[id=this->id, path] (const NCAsyncWorker<NCPath_result>* worker) {
+			NCPath_result result;
+			size_t end = path.find_last_not_of('/');
+			if (end == std::string::npos) {
+				char name[NC_MAX_NAME + 1];
+				NC_CALL(nc_inq_grpname(id, name));
+				result.kind = NCPath_result::GROUP;
+				result.id = id;
+				result.name = name;
+				return result;
+			}
+			size_t slash = path.find_last_of('/', end);
+			std::string group_path = slash == std::string::npos ? "" : path.substr(0, slash);
+			if (!group_path.empty() && group_path[0] != '/') {
+				group_path = "/" + group_path;
+			}
+			result.name = path.substr(slash == std::string::npos ? 0 : slash + 1, end - (slash == std::string::npos ? 0 : slash + 1) + 1);
+			result.parent_id = id;
+			if (group_path.find_first_not_of('/') != std::string::npos &&
+				nc_inq_grp_full_ncid(id, group_path.c_str(), &result.parent_id) != NC_NOERR) {
+				throw std::runtime_error(string_format("NetCDF4: Path %s not found", path.c_str()));
+			}
+			if (nc_inq_varid(result.parent_id, result.name.c_str(), &result.id) == NC_NOERR) {
+				result.kind = NCPath_result::VARIABLE;
+				NC_CALL(nc_inq_var(result.parent_id, result.id, NULL, &result.type, &result.ndims, NULL, NULL));
+			}
+			else if (nc_inq_grp_ncid(result.parent_id, result.name.c_str(), &result.id) == NC_NOERR) {
+				result.kind = NCPath_result::GROUP;
+			}
+			else if (nc_inq_dimid(result.parent_id, result.name.c_str(), &result.id) == NC_NOERR) {
+				result.kind = NCPath_result::DIMENSION;
+				NC_CALL(nc_inq_dimlen(result.parent_id, result.id, &result.len));
+			}
+			else {
+				throw std::runtime_error(string_format("NetCDF4: Path %s not found", path.c_str()));
+			}
+			return result;
+		},
+		[token=this->token] (Napi::Env env, NCPath_result result) -> Napi::Value {
+			switch (result.kind) {
+			case NCPath_result::VARIABLE:
+				return Variable::Build(env, result.id, result.parent_id, result.name, result.type, result.ndims, token);
+			case NCPath_result::GROUP:
+				return Group::Build(env, result.id, result.name, token);
+			default:
+				Napi::Object dimension = Napi::Object::New(env);
+				if (result.len == NC_UNLIMITED) {
+					dimension.Set(result.name, Napi::String::New(env, "unlimited"));
+				} else {
+					dimension.Set(result.name, Napi::Number::New(env, static_cast<double>(result.len)));
+				}
+				return dimension;
+			}
+		}
+	))->Queue(this->id);
+	return deferred.Promise();
+}
+
+/**
+ * @brief Dump metadata of whole file in one worker, like `ncdump -h`
+ * JSON is built natively, so option `{json:true}` returns it as is, otherwise it is parsed into object.
+ * Schema loaded at open is used if present, otherwise file is walked in the worker
+ * @param info NodeJS params
+ * @return Napi::Value Deferred promise resolved to `{format, root}` object or its JSON
+ */
+Napi::Value File::Describe(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+	if (this->closed) {
+		deferred.Reject(Napi::String::New(env, "File already closed"));
+		return deferred.Promise();
+	}
+	bool as_json = false;
+	if (info.Length() > 0 && info[0].IsObject()) {
+		as_json = info[0].As<Napi::Object>().Get("json").ToBoolean().Value();
+	}
+	auto worker = new NCAsyncWorker<std::string>(
+		env,
+		deferred,
+		[id=this->id, format=this->format] (const NCAsyncWorker<std::string>* worker) {
+			std::shared_ptr<const FileSchema> schema = SchemaRegistry::Instance().Find(id);
+			if (!schema) {
+				auto loaded = std::make_shared<FileSchema>();
+				NC_CALL(loadSchema(id, *loaded));
+				schema = loaded;
+			}
+			std::string json = string_format("{\"format\":\"%s\",\"root\":", NC_FORMATS(format));
+			describeGroup(*schema, id, json);
+			json += '}';
+			return json;
+		},
+		[as_json] (Napi::Env env, std::string result) -> Napi::Value {
+			Napi::String json = Napi::String::New(env, result);
+			if (as_json) {
+				return json;
+			}
+			Napi::Object JSON = env.Global().Get("JSON").As<Napi::Object>();
+			return JSON.Get("parse").As<Napi::Function>().Call(JSON, {json});
+		}
+	);
+	// Schema of file opened from metadata index is enough, file is not opened for it
+	worker->KeepDeferred();
+	worker->Queue(this->id);
+	return deferred.Promise();
+}
+
 /**
  * @brief Perform netCDF file sync. 
  * Synchronize data from memory to disk and vice verse.
@@ -274,7 +881,6 @@ Napi::Value File::Sync(const Napi::CallbackInfo &info) {
 			deferred,
 			[id] (const NCAsyncWorker<NCFile_result>* worker) {
 				static NCFile_result result;
-				std::unique_lock<std::shared_timed_mutex> lock(open_close);
 				result.id=id;
 		        NC_CALL(nc_sync(id))
 				return result;
@@ -285,7 +891,7 @@ Napi::Value File::Sync(const Napi::CallbackInfo &info) {
 			//	deferred.Resolve();
 			}
 			
-		))->Queue();
+		))->Queue(id);
 	}
 	else {
 		deferred.Reject(Napi::String::New(info.Env(), "File already closed"));
@@ -302,32 +908,37 @@ Napi::Value File::Sync(const Napi::CallbackInfo &info) {
 Napi::Value File::Close(const Napi::CallbackInfo &info) {
 	Napi::Env env = info.Env();
 	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
-	if (!this->closed) {
+	if (!this->closed && this->pooled) {
+		// Pooled handle stays open, promise is resolved after operations queued before close
 		this->closed=true;
-		int id=this->id;
+	*this->token=true;
 		this->Value().Delete("root");
-		(new NCAsyncWorker<NCFile_result>(
+		HandlePool::Instance().Release(this->id);
+		auto worker = new NCAsyncWorker<NCFile_result>(
 			env,
 			deferred,
-			[id] (const NCAsyncWorker<NCFile_result>* worker) {
+			[id=this->id] (const NCAsyncWorker<NCFile_result>* worker) {
 				static NCFile_result result;
-				std::unique_lock<std::shared_timed_mutex> lock(open_close);				
 				result.id=id;
-		        result.status=nc_close(id);
+				result.status=NC_NOERR;
 				return result;
-				// this->format=i;
 			},
 			[] (Napi::Env env,NCFile_result result)  {
 				Napi::Object obj=Napi::Object::New(env);
 				obj.Set("id",Napi::Number::New(env,result.id));
 				obj.Set("status",Napi::Number::New(env,result.status));
 				return obj;
-			//	deferred.Resolve();
 			}
-			
-		))->Queue();
-
-		
+		);
+		worker->KeepDeferred();
+		worker->Queue(this->id);
+		HandlePool::Instance().Evict(env);
+	}
+	else if (!this->closed) {
+		this->closed=true;
+	*this->token=true;
+		this->Value().Delete("root");
+		queue_close(env, deferred, this->id, this->executor, this->memory);
 	}
 	else {
 		deferred.Resolve(Napi::String::New(info.Env(),"File already closed"));
@@ -355,6 +966,16 @@ Napi::Value File::IsClosed(const Napi::CallbackInfo &info) {
 	return Napi::Boolean::New(info.Env(), closed);
 }
 
+/**
+ * @brief is file in define mode?
+ * Created files are in define mode until `dataMode()`
+ * @param info 
+ * @return Napi::Value NodeJS boolean
+ */
+Napi::Value File::IsDefineMode(const Napi::CallbackInfo &info) {
+	return Napi::Boolean::New(info.Env(), !closed && executor->GetState() == NCExecutor::DEFINE);
+}
+
 /**
  * @brief Return file format
  * 
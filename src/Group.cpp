@@ -4,6 +4,8 @@
 #include "netcdf4-async.h"
 #include "async.h"
 #include "Attribute.h"
+#include "Macros.h"
+#include "Schema.h"
 
 namespace netcdf4async {
 
@@ -19,6 +21,15 @@ struct NCGroup_result
 	std::string name;
 }; 
 
+/**
+ * @brief Values of variables read by readVariables
+ * 
+ */
+struct NCVariables_values
+{
+	std::vector<Item> values;
+};
+
 template <class NCResult> struct NCGroup_list
 {
 	std::vector<NCResult> groups;
@@ -45,11 +56,13 @@ struct VariableInfo{
 
 Napi::FunctionReference Group::constructor;
 
-Napi::Object Group::Build(Napi::Env env, int id,std::string name) {
-	return constructor.New({
+Napi::Object Group::Build(Napi::Env env, int id,std::string name, const std::shared_ptr<bool> &token) {
+	Napi::Object group = constructor.New({
 		Napi::Number::New(env, id),
 		Napi::String::New(env,name)
 	});
+	Group::Unwrap(group)->token = token;
+	return group;
 }
 
 Group::Group(const Napi::CallbackInfo &info) : Napi::ObjectWrap<Group>(info) {
@@ -87,9 +100,14 @@ void Group::Init(Napi::Env env) {
 
 		        InstanceMethod("getVariables",&Group::GetVariables),
 		        InstanceMethod("getVariable",&Group::GetVariable),
+		        InstanceMethod("readVariables",&Group::ReadVariables),
 				InstanceMethod("addVariable", &Group::AddVariable),
 
-		        InstanceMethod("inspect", &Group::Inspect)
+		        InstanceMethod("inspect", &Group::Inspect),
+		        InstanceAccessor<&Group::GetVariablesSync>("variables"),
+		        InstanceAccessor<&Group::GetDimensionsSync>("dimensions"),
+		        InstanceAccessor<&Group::GetSubgroupsSync>("subgroups"),
+		        InstanceAccessor<&Group::GetAttributesSync>("attributes")
 //                InstanceAccessor<&Group::GetId>("id"),
 			}
 		);
@@ -108,7 +126,7 @@ Napi::Value Group::AddAttribute(const Napi::CallbackInfo &info) {
 	std::string name=info[0].As<Napi::String>().ToString();
 	Napi::Env env = info.Env();
 	int id = this->id;
-	return add_attribute(env, deferred, id, NC_GLOBAL, name, type, info[2]);
+	return add_attribute(env, deferred, id, NC_GLOBAL, name, type, info[2], token);
 }
 
 Napi::Value Group::AddSubgroup(const Napi::CallbackInfo &info) {
@@ -127,17 +145,18 @@ Napi::Value Group::AddSubgroup(const Napi::CallbackInfo &info) {
 		[id, new_name] (const NCAsyncWorker<NCGroup_result>* worker) {
 			int new_id;
 			NC_CALL(nc_def_grp(id, new_name.c_str(),&new_id));
+			SchemaRegistry::Instance().RefreshGroup(id);
 			static NCGroup_result result;
             result.id = new_id;
 			result.name = new_name;
             return result;
 		},
-		[] (Napi::Env env, NCGroup_result result) {
-			Napi::Object group = Group::Build(env, result.id,result.name);
+		[token=this->token] (Napi::Env env, NCGroup_result result) {
+			Napi::Object group = Group::Build(env, result.id,result.name, token);
          	return group;
 		}
 		
-	))->Queue();
+	))->Queue(this->id, token);
     return deferred.Promise();
 }
 
@@ -167,6 +186,7 @@ Napi::Value Group::AddDimension(const Napi::CallbackInfo &info) {
 		[id=this->id,len,name] (const NCAsyncWorker<NCGroup_dims>* worker) {
 			NCGroup_dims result;
 			NC_CALL(nc_def_dim(id,name.c_str(),len,&result.id));
+			SchemaRegistry::Instance().RefreshGroup(id);
 			result.name=name;
 			result.len=len;
 			return result;
@@ -184,7 +204,7 @@ Napi::Value Group::AddDimension(const Napi::CallbackInfo &info) {
 		}
 
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
 
 	return worker->Deferred().Promise(); 
 
@@ -240,6 +260,7 @@ Napi::Value Group::AddVariable(const Napi::CallbackInfo &info) {
 			}
 			int new_id;
 			NC_CALL(nc_def_var(id,name.c_str(), type, dims_size, ndims ,&new_id));
+			SchemaRegistry::Instance().RefreshVariable(id, new_id);
 			delete[] ndims;
 			dim_name->clear();
 			dim_name->~vector();
@@ -251,13 +272,13 @@ Napi::Value Group::AddVariable(const Napi::CallbackInfo &info) {
 			result.type = type;
 			return result;
 		},
-		[] (Napi::Env env,VariableInfo result) {
+		[token=this->token] (Napi::Env env,VariableInfo result) {
 			
-			return Variable::Build(env,result.id, result.parent_id, result.name, result.type, result.ndims);
+			return Variable::Build(env,result.id, result.parent_id, result.name, result.type, result.ndims, token);
 		}
 
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
 
 	return worker->Deferred().Promise(); 
 }
@@ -289,17 +310,17 @@ Napi::Value Group::GetVariables(const Napi::CallbackInfo &info) {
 			delete[] var_ids;
 			return variables;
 		},
-		[] (Napi::Env env,std::vector<VariableInfo> result) {
+		[token=this->token] (Napi::Env env,std::vector<VariableInfo> result) {
 			Napi::Object vars = Napi::Object::New(env);	
 			for (auto var = result.begin(); var < result.end(); ++var) {
 				Napi::Object varObj = Variable::Build(env, var->var_id,
-					var->parent_id, var->name, var->type, var->ndims);
+					var->parent_id, var->name, var->type, var->ndims, token);
 		 		vars.Set(var->name, varObj);
 	 		}
 			return vars;
 		}
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
 	
     return worker->Deferred().Promise();
 }
@@ -319,38 +340,113 @@ Napi::Value Group::GetVariable(const Napi::CallbackInfo &info) {
 		env,
 		deferred,
 		[parent_id=this->id,var_name] (const NCAsyncWorker<VariableInfo>* worker) {
-			int nvars;
-			NC_CALL(nc_inq_varids(parent_id, &nvars, NULL));
-			int *var_ids = new int[nvars];
-			NC_CALL(nc_inq_varids(parent_id, NULL, var_ids));
 			VariableInfo varInfo;
-			char varName[NC_MAX_NAME + 1];
 			varInfo.parent_id = parent_id;
-			for(int i=0; i<nvars; i++){
-				varInfo.var_id = var_ids[i];
-				NC_CALL(nc_inq_var(varInfo.parent_id, varInfo.var_id, varName, &varInfo.type, &varInfo.ndims, NULL, NULL));
-				if (var_name == varName) {
-					varInfo.name = std::string(varName);
-					delete[] var_ids;
-					return varInfo;
-				}
+			// libnetcdf keeps names indexed, so lookup does not depend on number of variables
+			if (nc_inq_varid(parent_id, var_name.c_str(), &varInfo.var_id) != NC_NOERR) {
+				throw std::runtime_error(string_format("NetCDF4: Variable %s not found",var_name.c_str()));
 			}
-			delete[] var_ids;
-			throw std::runtime_error(string_format("NetCDF4: Variable %s not found",var_name.c_str()));
+			NC_CALL(nc_inq_var(varInfo.parent_id, varInfo.var_id, NULL, &varInfo.type, &varInfo.ndims, NULL, NULL));
+			varInfo.name = var_name;
+			return varInfo;
 		},
-		[] (Napi::Env env,VariableInfo result) {
+		[token=this->token] (Napi::Env env,VariableInfo result) {
 			Napi::Object varObj = Variable::Build(env, result.var_id,
-				result.parent_id, result.name, result.type, result.ndims);
+				result.parent_id, result.name, result.type, result.ndims, token);
 			return varObj;
 		}
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
 
 
     return deferred.Promise();
 }
 
 
+/**
+ * @brief Read same hyperslab of many variables in one worker
+ * Parameter is object `{names, start, count[, stride]}`
+ * @param info NodeJS params
+ * @return Napi::Value Deferred promise resolved to object with value of each variable
+ */
+Napi::Value Group::ReadVariables(const Napi::CallbackInfo &info) {
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(info.Env());
+	Napi::Env env = info.Env();
+
+	if (info.Length() != 1 || !info[0].IsObject()) {
+		deferred.Reject(Napi::String::New(env, "Expecting an object with names, start and count"));
+		return deferred.Promise();
+	}
+	Napi::Object request = info[0].As<Napi::Object>();
+	Napi::Value names_value = request.Get("names");
+	Napi::Value start_value = request.Get("start");
+	if (!names_value.IsArray() || !start_value.IsArray()) {
+		deferred.Reject(Napi::String::New(env, "Expecting an object with names, start and count"));
+		return deferred.Promise();
+	}
+	Hyperslab slab;
+	int ndims = static_cast<int>(start_value.As<Napi::Array>().Length());
+	if (!parseHyperslab(request, ndims, slab)) {
+		deferred.Reject(Napi::String::New(env, "Wrong hyperslab"));
+		return deferred.Promise();
+	}
+	Napi::Array names_array = names_value.As<Napi::Array>();
+	std::vector<std::string> names;
+	for (uint32_t i = 0; i < names_array.Length(); i++) {
+		names.push_back(names_array.Get(i).ToString().Utf8Value());
+	}
+
+	auto worker=new NCAsyncWorker<NCVariables_values>(
+		env,
+		deferred,
+		[parent_id=this->id, names, slab, ndims] (const NCAsyncWorker<NCVariables_values>* worker) {
+			NCVariables_values result;
+			try {
+				for (auto &name : names) {
+					Item item;
+					int var_id;
+					int var_ndims;
+					NC_CALL(nc_inq_varid(parent_id, name.c_str(), &var_id));
+					NC_CALL(nc_inq_var(parent_id, var_id, NULL, &item.type, &var_ndims, NULL, NULL));
+					if (var_ndims != ndims) {
+						throw std::runtime_error(string_format("NetCDF4: Variable %s has %i dimension(s)", name.c_str(), var_ndims));
+					}
+#if NODE_MAJOR_VERSION >= 10
+					if (item.type < NC_BYTE || (item.type > NC_UINT64 && item.type != NC_STRING)) {
+#else
+					if (item.type < NC_BYTE || (item.type > NC_UINT && item.type != NC_STRING)) {
+#endif
+						throw std::runtime_error(string_format("NetCDF4: Variable %s type not supported yet", name.c_str()));
+					}
+					item.name = name;
+					item.len = slab.len;
+					typedValue(&item);
+					result.values.push_back(item);
+					NC_CALL(readHyperslab(parent_id, var_id, slab, item.value.v));
+				}
+			}
+			catch (...) {
+				// Values of variables read before failure are not returned
+				for (auto &item : result.values) {
+					releaseItem(&item);
+				}
+				throw;
+			}
+			return result;
+		},
+		[] (Napi::Env env, NCVariables_values result) {
+			Napi::Object values = Napi::Object::New(env);
+			for (auto &item : result.values) {
+				values.Set(item.name, item2value(env, &item));
+			}
+			return values;
+		}
+	);
+	worker->Queue(this->id, token);
+
+	return deferred.Promise();
+}
+
 Napi::Value Group::GetDimensions(const Napi::CallbackInfo &info) {
 	bool unlimited=false;
 	Napi::Env env = info.Env();
@@ -404,7 +500,7 @@ Napi::Value Group::GetDimensions(const Napi::CallbackInfo &info) {
 		}
 
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
 
 	return worker->Deferred().Promise(); 
 
@@ -418,7 +514,7 @@ Napi::Value Group::GetAttributes(const Napi::CallbackInfo &info) {
 	}
 	Napi::Env env = info.Env();
 	int id = this->id;
- 	return netcdf4async::get_attributes(env, id, NC_GLOBAL, return_type);
+ 	return netcdf4async::get_attributes(env, id, NC_GLOBAL, return_type, token);
 }
 
 Napi::Value Group::GetSubgroups(const Napi::CallbackInfo &info) {
@@ -446,17 +542,17 @@ Napi::Value Group::GetSubgroups(const Napi::CallbackInfo &info) {
 
             return result;
 		},
-		[] (Napi::Env env,NCGroup_list<NCGroup_result> result) {
+		[token=this->token] (Napi::Env env,NCGroup_list<NCGroup_result> result) {
 			Napi::Object subgroups = Napi::Object::New(env);
 			for (auto nc_group= result.groups.begin(); nc_group != result.groups.end(); nc_group++){
-				Napi::Object group = Group::Build(env, nc_group->id,nc_group->name);
+				Napi::Object group = Group::Build(env, nc_group->id,nc_group->name, token);
 				subgroups.Set(Napi::String::New(env,nc_group->name), group);
 			}
          	return subgroups;
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
 
 	return worker->Deferred().Promise(); 
 }
@@ -474,28 +570,19 @@ Napi::Value Group::GetSubgroup(const Napi::CallbackInfo &info) {
 	auto worker=new NCAsyncWorker<NCGroup_result>(
 		env,
 		[id=this->id,group_name] (const NCAsyncWorker<NCGroup_result>* worker) {
-			int ngrps;
-			NC_CALL(nc_inq_grps(id, &ngrps, NULL));
-			int *grp_ids = new int[ngrps];
-			NC_CALL(nc_inq_grps(id, NULL, grp_ids));
-			char name[NC_MAX_NAME + 1];
-			for (int i = 0; i < ngrps; ++i) {
-				int retval = nc_inq_grpname(grp_ids[i], name);
-				if (retval == NC_NOERR && group_name==name) {
-					NCGroup_result result;
-					result.id = grp_ids[i];
-					result.name = name;
-					return result;
-				}
+			NCGroup_result result;
+			if (nc_inq_grp_ncid(id, group_name.c_str(), &result.id) != NC_NOERR) {
+				throw std::runtime_error(string_format("NetCDF4: Bad or missing group \"%s\"",group_name.c_str()));
 			}
-			throw std::runtime_error(string_format("NetCDF4: Bad or missing group \"%s\"",group_name.c_str()));
+			result.name = group_name;
+			return result;
 		},
-		[] (Napi::Env env,NCGroup_result result) {
-			return Group::Build(env, result.id,result.name);
+		[token=this->token] (Napi::Env env,NCGroup_result result) {
+			return Group::Build(env, result.id,result.name, token);
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
 
 	return worker->Deferred().Promise(); 
 }
@@ -522,7 +609,7 @@ Napi::Value Group::GetName(const Napi::CallbackInfo &info) {
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
     return worker->Deferred().Promise();
 }
 
@@ -544,6 +631,7 @@ Napi::Value Group::SetName(const Napi::CallbackInfo &info) {
             result.id = id;
             result.name =  new_name;
             NC_CALL(nc_rename_grp(id, new_name.c_str()));
+            SchemaRegistry::Instance().RefreshGroup(id);
             return result;
 		},
 		[pGroup] (Napi::Env env, NCGroup_result result) mutable {
@@ -551,7 +639,7 @@ Napi::Value Group::SetName(const Napi::CallbackInfo &info) {
          	return Napi::String::New(env, result.name);
 		}
 		
-	))->Queue();
+	))->Queue(this->id, token);
     return deferred.Promise();
 }
 
@@ -580,10 +668,78 @@ Napi::Value Group::GetPath(const Napi::CallbackInfo &info) {
 	   	}
 	
 	);
-	worker->Queue();
+	worker->Queue(this->id, token);
     return worker->Deferred().Promise();
 }
 
+/**
+ * @brief Variables of group from schema loaded at open
+ * @param info NodeJS params
+ * @return Napi::Value Object with Variable of each name, as resolved by getVariables
+ */
+Napi::Value Group::GetVariablesSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const GroupSchema &group = findGroupSchema(env, this->id, file);
+	Napi::Object vars = Napi::Object::New(env);
+	for (auto &entry : group.variables) {
+		const VariableSchema &var = *entry.second;
+		vars.Set(var.name, Variable::Build(env, var.id, this->id, var.name, var.type, static_cast<int>(var.dimids.size()), token));
+	}
+	return vars;
+}
+
+/**
+ * @brief Dimensions of group from schema loaded at open
+ * @param info NodeJS params
+ * @return Napi::Value Object with length of each dimension, as resolved by getDimensions
+ */
+Napi::Value Group::GetDimensionsSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const GroupSchema &group = findGroupSchema(env, this->id, file);
+	Napi::Object dimensions = Napi::Object::New(env);
+	for (auto &dimension : group.dimensions) {
+		dimensions.Set(dimension.name, dimensionLength(env, dimension.len));
+	}
+	return dimensions;
+}
+
+/**
+ * @brief Subgroups of group from schema loaded at open
+ * @param info NodeJS params
+ * @return Napi::Value Object with Group of each name, as resolved by getSubgroups
+ */
+Napi::Value Group::GetSubgroupsSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const GroupSchema &group = findGroupSchema(env, this->id, file);
+	Napi::Object subgroups = Napi::Object::New(env);
+	for (auto subgroup_id : group.subgroups) {
+		auto it = file->groups.find(subgroup_id);
+		if (it != file->groups.end()) {
+			subgroups.Set(it->second->name, Group::Build(env, subgroup_id, it->second->name, token));
+		}
+	}
+	return subgroups;
+}
+
+/**
+ * @brief Attributes of group from schema loaded at open
+ * @param info NodeJS params
+ * @return Napi::Value Object with value of each attribute, as resolved by getAttributes(false)
+ */
+Napi::Value Group::GetAttributesSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const GroupSchema &group = findGroupSchema(env, this->id, file);
+	Napi::Object attributes = Napi::Object::New(env);
+	for (auto &attribute : group.attributes) {
+		attributes.Set(attribute.name, schemaValue(env, attribute.value));
+	}
+	return attributes;
+}
+
 Napi::Value Group::Inspect(const Napi::CallbackInfo &info) {
 	return Napi::String::New(info.Env(), 
 		string_format(
@@ -0,0 +1,149 @@
+#include <netcdf.h>
+#include "netcdf4-async.h"
+#include "async.h"
+#include "ResultCache.h"
+#include "Schema.h"
+#include "AdaptiveCache.h"
+#include "MetadataIndex.h"
+#include "HandlePool.h"
+
+namespace netcdf4async {
+
+    HandlePool::HandlePool() : capacity(0), hits(0), misses(0), evictions(0) {
+    }
+
+    /**
+     * @brief Pool instance
+     * Pool is never destroyed, as other process-wide singletons
+     * @return HandlePool&
+     */
+    HandlePool &HandlePool::Instance() {
+        static HandlePool *pool=new HandlePool();
+        return *pool;
+    }
+
+    bool HandlePool::Key(const std::string &path, bool schema, std::string &key) {
+        std::vector<int64_t> identity;
+        if (!file_identity(path, identity)) {
+            return false;
+        }
+        key=path;
+        for (auto value : identity) {
+            key+=string_format("|%lld", static_cast<long long>(value));
+        }
+        key+=schema ? "|schema" : "";
+        return true;
+    }
+
+    bool HandlePool::Acquire(const std::string &key, int &id, int &format, std::string &root_name) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=handles.find(key);
+        if (it == handles.end()) {
+            misses++;
+            return false;
+        }
+        Entry &entry=it->second;
+        if (entry.refs++ == 0) {
+            idle.erase(entry.position);
+        }
+        id=entry.id;
+        format=entry.format;
+        root_name=entry.root_name;
+        hits++;
+        return true;
+    }
+
+    bool HandlePool::Add(const std::string &key, int id, int format, const std::string &root_name) {
+        std::lock_guard<std::mutex> guard(lock);
+        // File could be opened twice at once, only first handle is pooled then
+        if (handles.find(key) != handles.end()) {
+            return false;
+        }
+        Entry entry;
+        entry.id=id;
+        entry.format=format;
+        entry.root_name=root_name;
+        entry.refs=1;
+        handles[key]=entry;
+        keys[id]=key;
+        return true;
+    }
+
+    void HandlePool::Release(int id) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto key=keys.find(id);
+        if (key == keys.end()) {
+            return;
+        }
+        Entry &entry=handles[key->second];
+        if (--entry.refs == 0) {
+            entry.position=idle.insert(idle.end(), id);
+        }
+    }
+
+    /**
+     * @brief Close least recently used idle handles beyond capacity
+     * Handles are taken out of pool at once, so they are never acquired again while closing
+     */
+    void HandlePool::Evict(Napi::Env env) {
+        std::vector<int> closing;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            while (idle.size() > capacity) {
+                int id=idle.front();
+                idle.pop_front();
+                handles.erase(keys[id]);
+                keys.erase(id);
+                closing.push_back(id);
+                evictions++;
+            }
+        }
+        for (auto id : closing) {
+            ResultCache::Instance().UnregisterFile(id);
+            SchemaRegistry::Instance().Remove(id);
+            AdaptiveCacheRegistry::Instance().Remove(id);
+            Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+            auto worker=new NCAsyncWorker<int>(
+                env,
+                deferred,
+                [id] (const NCAsyncWorker<int>* worker) {
+                    return nc_close(id);
+                },
+                [] (Napi::Env env, int status) {
+                    return Napi::Number::New(env, status);
+                }
+            );
+            auto executor=find_executor(id);
+            worker->KeepDeferred();
+            worker->Queue(id);
+            if (executor) {
+                executor->SetState(NCExecutor::CLOSING);
+            }
+        }
+    }
+
+    void HandlePool::Resize(size_t handles) {
+        std::lock_guard<std::mutex> guard(lock);
+        capacity=handles;
+    }
+
+    size_t HandlePool::Capacity() {
+        std::lock_guard<std::mutex> guard(lock);
+        return capacity;
+    }
+
+    bool HandlePool::Enabled() {
+        std::lock_guard<std::mutex> guard(lock);
+        return capacity > 0;
+    }
+
+    void HandlePool::Stats(uint64_t &hits, uint64_t &misses, uint64_t &evictions, size_t &open, size_t &idle) {
+        std::lock_guard<std::mutex> guard(lock);
+        hits=this->hits;
+        misses=this->misses;
+        evictions=this->evictions;
+        open=handles.size();
+        idle=this->idle.size();
+    }
+
+}
@@ -0,0 +1,88 @@
+#ifndef NETCDF4_HANDLEPOOL_H
+#define NETCDF4_HANDLEPOOL_H
+
+#include <napi.h>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace netcdf4async {
+
+    /**
+     * @brief Process-wide pool of read only file handles
+     * Files opened in `r` mode on the same unchanged path share one ncid (and its executor) with reference count.
+     * Handles without references are kept open up to capacity and the least recently used ones are closed,
+     * so hot files are opened once. Pool is disabled until capacity is set.
+     */
+    class HandlePool {
+        public:
+            /// @brief Pool instance
+            /// @return pool
+            static HandlePool &Instance();
+            /// @brief Take reference to open handle of file
+            /// @param key File key, see Key
+            /// @param id NetCDF file id
+            /// @param format File format
+            /// @param root_name Root group name
+            /// @return true if handle is found
+            bool Acquire(const std::string &key, int &id, int &format, std::string &root_name);
+            /// @brief Add just opened handle with one reference
+            /// @param key File key
+            /// @param id NetCDF file id
+            /// @param format File format
+            /// @param root_name Root group name
+            /// @return false if other handle of file was added meanwhile, handle is not pooled then
+            bool Add(const std::string &key, int id, int format, const std::string &root_name);
+            /// @brief Drop reference. Handle without references becomes idle, it is closed by Evict
+            /// @param id NetCDF file id
+            void Release(int id);
+            /// @brief Close idle handles beyond capacity through their executors,
+            /// so operations queued before file was released complete first
+            /// @param env NodeJS environment
+            void Evict(Napi::Env env);
+            /// @brief Change capacity
+            /// @param handles Max number of idle handles, 0 disables pool
+            void Resize(size_t handles);
+            /// @brief Max number of idle handles
+            size_t Capacity();
+            /// @brief Is pool enabled
+            bool Enabled();
+            /// @brief Counters
+            /// @param hits Opens served by pooled handle
+            /// @param misses Opens which had to open file
+            /// @param evictions Idle handles closed
+            /// @param open Handles in pool
+            /// @param idle Handles without references
+            void Stats(uint64_t &hits, uint64_t &misses, uint64_t &evictions, size_t &open, size_t &idle);
+            /// @brief Key of file: path, identity of its contents and open options changing handle
+            /// @param path File path
+            /// @param schema Schema is loaded
+            /// @param key Key
+            /// @return false if file can't be stat'ed
+            static bool Key(const std::string &path, bool schema, std::string &key);
+        private:
+            struct Entry {
+                int id;
+                int format;
+                std::string root_name;
+                size_t refs;
+                std::list<int>::iterator position;
+            };
+            HandlePool();
+            std::mutex lock;
+            std::map<std::string, Entry> handles;
+            std::map<int, std::string> keys;
+            /// @brief Idle handles, least recently used first
+            std::list<int> idle;
+            size_t capacity;
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+    };
+
+}
+
+#endif
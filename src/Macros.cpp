@@ -6,9 +6,38 @@
 #include "utils.h"
 #include <node_version.h>
 #include "Macros.h"
+#include "Decimator.h"
 
 namespace netcdf4async {
 
+bool external_buffers = false;
+
+/**
+ * @brief Detect if runtime allows to hand native buffers to ArrayBuffer
+ * Node 14-17 may crash when address of freed external buffer is wrapped again
+ * (https://github.com/nodejs/node/issues/32463), and some runtimes (e.g. Electron
+ * with V8 sandbox) do not allow external buffers at all. Read buffers are copied there.
+ * @param env NodeJS environment
+ */
+void detectExternalBuffers(Napi::Env env) {
+	const napi_node_version *version;
+	if (napi_get_node_version(env, &version) != napi_ok ||
+		(version->major >= 14 && version->major < 18)) {
+		external_buffers = false;
+		return;
+	}
+	int8_t *probe = new int8_t[1];
+	try {
+		Napi::ArrayBuffer::New(env, probe, 1, [](Napi::Env env, void *data) {
+			delete[] static_cast<int8_t *>(data);
+		});
+		external_buffers = true;
+	} catch (const Napi::Error &e) {
+		delete[] probe;
+		external_buffers = false;
+	}
+}
+
 
 Napi::Value item2value(Napi::Env env, Item *nc_item) {
 	Napi::Value value;
@@ -46,7 +75,7 @@ Napi::Value item2value(Napi::Env env, Item *nc_item) {
 		break;
 		case NC_CHAR: 
 			value = Napi::String::New(env, nc_item->value.s);
-			delete[] nc_item->value.s;
+			BufferPool::Instance().Release(nc_item->value.v);
 		break;
 		case NC_STRING:
 			if (nc_item->len == 1) {
@@ -68,6 +97,32 @@ Napi::Value item2value(Napi::Env env, Item *nc_item) {
 	return value;
 }
 
+/**
+ * @brief Return buffer of value converted by VAL_TO_ITEM to buffer pool, when value is written
+ * Characters and strings are not taken from pool and are left as they are
+ * @param type NetCDF type of value
+ * @param data Buffer
+ */
+void releaseValue(int type, void *data) {
+	if (type != NC_CHAR && type != NC_STRING) {
+		BufferPool::Instance().Release(data);
+	}
+}
+
+/**
+ * @brief Free buffer allocated by typedValue, when read value is not handed to item2value, e.g. after failed read
+ * @param pItem Item, its buffer is cleared
+ */
+void releaseItem(Item *pItem) {
+	if (pItem->type == NC_STRING) {
+		delete[] pItem->value.ps;
+	}
+	else {
+		BufferPool::Instance().Release(pItem->value.v);
+	}
+	pItem->value.v = NULL;
+}
+
 void typedValue(Item* pItem) {
     switch (pItem->type) {
 	case NC_BYTE: 
@@ -114,4 +169,162 @@ void typedValue(Item* pItem) {
 	}
 }
 
-}
\ No newline at end of file
+/**
+ * @brief Check if TypedArray could hold values of netcdf type without conversion
+ * 
+ * @param type netcdf type
+ * @param array_type TypedArray type
+ * @return true if memory layout is the same
+ */
+bool typedArrayMatches(int type, napi_typedarray_type array_type) {
+	switch (type) {
+	case NC_BYTE:
+		return array_type == napi_int8_array;
+	case NC_UBYTE:
+		return array_type == napi_uint8_array || array_type == napi_uint8_clamped_array;
+	case NC_SHORT:
+		return array_type == napi_int16_array;
+	case NC_USHORT:
+		return array_type == napi_uint16_array;
+	case NC_INT:
+		return array_type == napi_int32_array;
+	case NC_UINT:
+		return array_type == napi_uint32_array;
+	case NC_FLOAT:
+		return array_type == napi_float32_array;
+	case NC_DOUBLE:
+		return array_type == napi_float64_array;
+#if NODE_MAJOR_VERSION > 9
+	case NC_INT64:
+		return array_type == napi_bigint64_array;
+	case NC_UINT64:
+		return array_type == napi_biguint64_array;
+#endif
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Size of value of atomic fixed-size type
+ * @param type NetCDF type
+ * @return size_t Size in bytes, 0 for strings and unsupported types
+ */
+size_t typeSize(int type) {
+	switch (type) {
+	case NC_BYTE:
+	case NC_UBYTE:
+	case NC_CHAR:
+		return 1;
+	case NC_SHORT:
+	case NC_USHORT:
+		return 2;
+	case NC_INT:
+	case NC_UINT:
+	case NC_FLOAT:
+		return 4;
+	case NC_DOUBLE:
+	case NC_INT64:
+	case NC_UINT64:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief Parse hyperslab descriptor `{start, count[, stride]}`
+ * @param value NodeJS descriptor
+ * @param ndims Number of variable dimensions, length of each array
+ * @param slab Parsed hyperslab
+ * @return true if descriptor is valid
+ */
+bool parseHyperslab(Napi::Value value, int ndims, Hyperslab &slab) {
+	if (!value.IsObject()) {
+		return false;
+	}
+	Napi::Object descriptor = value.As<Napi::Object>();
+	Napi::Value start = descriptor.Get("start");
+	Napi::Value count = descriptor.Get("count");
+	Napi::Value stride = descriptor.Get("stride");
+	bool strided = !(stride.IsUndefined() || stride.IsNull());
+	if (!start.IsArray() || !count.IsArray() || (strided && !stride.IsArray())) {
+		return false;
+	}
+	Napi::Array start_array = start.As<Napi::Array>();
+	Napi::Array count_array = count.As<Napi::Array>();
+	if (start_array.Length() != static_cast<uint32_t>(ndims) || count_array.Length() != static_cast<uint32_t>(ndims) ||
+		(strided && stride.As<Napi::Array>().Length() != static_cast<uint32_t>(ndims))) {
+		return false;
+	}
+	slab.start.resize(ndims);
+	slab.count.resize(ndims);
+	slab.stride.resize(strided ? ndims : 0);
+	slab.len = 1;
+	for (int i = 0; i < ndims; i++) {
+		Napi::Value p = start_array.Get(i);
+		Napi::Value c = count_array.Get(i);
+		if (!p.IsNumber() || !c.IsNumber() || p.As<Napi::Number>().Int64Value() < 0 || c.As<Napi::Number>().Int64Value() < 0) {
+			return false;
+		}
+		slab.start[i] = p.As<Napi::Number>().Int64Value();
+		slab.count[i] = c.As<Napi::Number>().Int64Value();
+		slab.len *= slab.count[i];
+		if (strided) {
+			Napi::Value st = stride.As<Napi::Array>().Get(i);
+			if (!st.IsNumber() || st.As<Napi::Number>().Int64Value() < 1) {
+				return false;
+			}
+			slab.stride[i] = static_cast<ptrdiff_t>(st.As<Napi::Number>().Int64Value());
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Read hyperslab with nc_get_vara, or strided hyperslab through read planner
+ * @return int NetCDF status
+ */
+int readHyperslab(int ncid, int varid, const Hyperslab &slab, void *data) {
+	if (slab.stride.empty()) {
+		return nc_get_vara(ncid, varid, slab.start.data(), slab.count.data(), data);
+	}
+	return read_strided(ncid, varid, slab, data);
+}
+
+/**
+ * @brief Parse chunk cache settings `{size, nelems, preemption}`
+ * @param value NodeJS settings object
+ * @param cache Parsed settings
+ * @param error Error message if settings are wrong
+ * @return true if settings are valid
+ */
+bool parseChunkCache(Napi::Value value, ChunkCache &cache, std::string &error) {
+	if (!value.IsObject()) {
+		error = "Expecting an object with chunk cache settings";
+		return false;
+	}
+	Napi::Object settings = value.As<Napi::Object>();
+	Napi::Value size = settings.Get("size");
+	Napi::Value nelems = settings.Get("nelems");
+	Napi::Value preemption = settings.Get("preemption");
+	cache.has_size = !size.IsUndefined();
+	cache.has_nelems = !nelems.IsUndefined();
+	cache.has_preemption = !preemption.IsUndefined();
+	if ((cache.has_size && (!size.IsNumber() || size.As<Napi::Number>().Int64Value() < 0)) ||
+		(cache.has_nelems && (!nelems.IsNumber() || nelems.As<Napi::Number>().Int64Value() < 1))) {
+		error = "Chunk cache size and nelems must be positive integers";
+		return false;
+	}
+	if (cache.has_preemption && (!preemption.IsNumber() ||
+		preemption.As<Napi::Number>().DoubleValue() < 0 || preemption.As<Napi::Number>().DoubleValue() > 1)) {
+		error = "Chunk cache preemption must be between 0 and 1";
+		return false;
+	}
+	cache.size = cache.has_size ? static_cast<size_t>(size.As<Napi::Number>().Int64Value()) : 0;
+	cache.nelems = cache.has_nelems ? static_cast<size_t>(nelems.As<Napi::Number>().Int64Value()) : 0;
+	cache.preemption = cache.has_preemption ? preemption.As<Napi::Number>().FloatValue() : 0;
+	return true;
+}
+
+}
@@ -4,7 +4,9 @@
 
 #include <string.h>
 #include <stdexcept>
+#include <vector>
 #include <node_version.h>
+#include "BufferPool.h"
 
 #define NAPI_uint8_t Number
 #define NAPI_uint16_t Number
@@ -89,7 +91,7 @@
 #define NAPI_Union(v) NAPI_Union_##v
 
 #define TYPED_VALUE(name,type,size)  \
-        name.NAPI_Union(type)=new type[size];
+        name.NAPI_Union(type)=netcdf4async::BufferPool::Instance().Allocate<type>(size);
 
 #define ITEM_TO_VAL(type)                                          \
         if (nc_item->len == 1) {                              \
@@ -97,26 +99,39 @@
                 env,                                               \
                 nc_item->value.NAPI_Union(type)[0]            \
             );                                                     \
-            delete[] nc_item->value.NAPI_Union(type);         \
+            netcdf4async::BufferPool::Instance().Release(nc_item->value.v); \
+        }                                                          \
+        else if (netcdf4async::external_buffers) {                 \
+            /* Hand buffer ownership to ArrayBuffer */             \
+            auto ab=Napi::ArrayBuffer::New(                        \
+                env,                                               \
+                nc_item->value.v,                                  \
+                nc_item->len * sizeof(type),                  \
+                [](Napi::Env env, void *data) {                    \
+                        netcdf4async::BufferPool::Instance().Release(data); \
+                }                                                  \
+            );                                                     \
+            value = Napi::NAPI_Array(type)::New(                   \
+                env,                                               \
+                nc_item->len,                                 \
+                ab,                                                \
+                0                                                  \
+            );                                                     \
         }                                                          \
         else {                                                     \
             /* Workaround bug in nodejs v8. */                     \
             /* At least after Node 14, confirmed in Node 16 */     \
             /* See https://github.com/nodejs/node/issues/32463 */  \
-            void* data = malloc(nc_item->len * sizeof(type)); \
+            auto ab=Napi::ArrayBuffer::New(                        \
+                env,                                               \
+                nc_item->len * sizeof(type)                   \
+            );                                                     \
             memcpy(                                                \
-                data,                                              \
+                ab.Data(),                                         \
                 nc_item->value.v,                             \
                 nc_item->len * sizeof(type)                   \
             );                                                     \
-            auto ab=Napi::ArrayBuffer::New(                        \
-                env,                                               \
-                data,                                              \
-                nc_item->len * sizeof(type),                  \
-                [](Napi::Env env, void *data) {                    \
-                        free(data);                                \
-                }                                                  \
-            );                                                     \
+            netcdf4async::BufferPool::Instance().Release(nc_item->value.v); \
             value = Napi::NAPI_Array(type)::New(                   \
                 env,                                               \
                 nc_item->len,                                 \
@@ -131,7 +146,7 @@
 #define BIGINT_TO_ITEM(type)                                           \
    else if (value.IsBigInt()) {                                        \
 		nc_item.len = 1;                                       \
-		type* pv = new type[nc_item.len];                      \
+		type* pv = netcdf4async::BufferPool::Instance().Allocate<type>(nc_item.len);                      \
         bool loseless=0;                                               \
         Napi::Number number=Napi::Number::New(                         \
             env,                                                       \
@@ -149,14 +164,17 @@
 #define VAL_TO_ITEM(type)                                                \
     if (value.IsNumber()) {                                              \
 		nc_item.len = 1;                                         \
-		type* pv = new type[nc_item.len];                        \
+		type* pv = netcdf4async::BufferPool::Instance().Allocate<type>(nc_item.len);                        \
 		pv[0] = value.As<Napi::NAPI_Type(type)>().NAPI_Value(type)();    \
 		nc_item.value.v = pv;                                    \
     } BIGINT_TO_ITEM(type)                                               \
     else if (value.IsTypedArray()){                                      \
         auto array = value.As<Napi::NAPI_Array(type)>();                 \
         nc_item.len = array.ElementLength();                     \
-        nc_item.value.v = array.ArrayBuffer().Data();            \
+        /* Item owns its buffer, see releaseValue */                 \
+        type* pv = netcdf4async::BufferPool::Instance().Allocate<type>(nc_item.len);                        \
+        memcpy(pv, array.Data(), nc_item.len * sizeof(type));    \
+        nc_item.value.v = pv;                                    \
     } else {                                                             \
         deferred.Reject(                                                 \
             Napi::String::New(                                           \
@@ -194,7 +212,45 @@ namespace netcdf4async {
         UnionType value;
     };
 
+    /// @brief Hyperslab of variable, stride is empty for contiguous hyperslab
+    struct Hyperslab
+    {
+        std::vector<size_t> start;
+        std::vector<size_t> count;
+        std::vector<ptrdiff_t> stride;
+        size_t len;
+    };
+
+    /// @brief HDF5 chunk cache settings. Missing fields keep current values
+    struct ChunkCache
+    {
+        size_t size;
+        size_t nelems;
+        float preemption;
+        bool has_size;
+        bool has_nelems;
+        bool has_preemption;
+    };
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    /// @brief Host byte order is big-endian, as in netCDF-3 files
+    const bool big_endian_host = true;
+#else
+    const bool big_endian_host = false;
+#endif
+
+    /// @brief Could read buffers be handed to ArrayBuffer without copy
+    /// Detected at module load, see detectExternalBuffers
+    extern bool external_buffers;
+    void detectExternalBuffers(Napi::Env env);
     Napi::Value item2value(Napi::Env env, Item *nc_item);
     void typedValue(Item* pItem);
+    void releaseValue(int type, void *data);
+    void releaseItem(Item *pItem);
+    bool typedArrayMatches(int type, napi_typedarray_type array_type);
+    size_t typeSize(int type);
+    bool parseHyperslab(Napi::Value value, int ndims, Hyperslab &slab);
+    int readHyperslab(int ncid, int varid, const Hyperslab &slab, void *data);
+    bool parseChunkCache(Napi::Value value, ChunkCache &cache, std::string &error);
 }
 #endif
\ No newline at end of file
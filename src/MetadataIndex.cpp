@@ -0,0 +1,390 @@
+#include <netcdf.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdexcept>
+#include "netcdf4-async.h"
+#include "async.h"
+#include "Schema.h"
+#include "MetadataIndex.h"
+
+namespace netcdf4async {
+
+    std::atomic<uint64_t> metadata_index_hits(0);
+    std::atomic<uint64_t> metadata_index_misses(0);
+    std::atomic<uint64_t> metadata_index_deferred_opens(0);
+
+    /// @brief Index header. Version of libnetcdf is part of it, as group ids depend on library
+    static const std::string index_magic = std::string("NC4AIDX1 ") + NC_VERSION;
+    /// @brief Written in host byte order, so index of other architecture does not match
+    static const int64_t index_byte_order = 0x0102030405060708LL;
+
+    /// @brief Empty classic file: magic, numrecs and three absent lists
+    static char placeholder_file[32] = {'C', 'D', 'F', 1};
+
+    /**
+     * @brief Open empty in-memory file. It is cheap and takes lowest free ncid slot as any other file
+     */
+    static int open_placeholder(int *id) {
+        return nc_open_mem("netcdf4-async placeholder", NC_NOWRITE, sizeof(placeholder_file), placeholder_file, id);
+    }
+
+    bool file_identity(const std::string &path, std::vector<int64_t> &key) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            return false;
+        }
+#ifdef __APPLE__
+        int64_t mtime_ns = st.st_mtimespec.tv_nsec;
+#else
+        int64_t mtime_ns = st.st_mtim.tv_nsec;
+#endif
+        key = {static_cast<int64_t>(st.st_dev), static_cast<int64_t>(st.st_ino), static_cast<int64_t>(st.st_size),
+            static_cast<int64_t>(st.st_mtime), mtime_ns};
+        return true;
+    }
+
+    class IndexWriter {
+        public:
+            void Int(int64_t value) {
+                data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+            }
+            void String(const std::string &value) {
+                Int(static_cast<int64_t>(value.size()));
+                data += value;
+            }
+            void Value(const SchemaValue &value) {
+                Int(value.type);
+                Int(static_cast<int64_t>(value.len));
+                String(std::string(value.bytes.begin(), value.bytes.end()));
+                Int(static_cast<int64_t>(value.strings.size()));
+                for (auto &s : value.strings) {
+                    String(s);
+                }
+            }
+            void Attributes(const std::vector<AttributeSchema> &attributes) {
+                Int(static_cast<int64_t>(attributes.size()));
+                for (auto &attribute : attributes) {
+                    String(attribute.name);
+                    Value(attribute.value);
+                }
+            }
+            template <class T> void Ints(const std::vector<T> &values) {
+                Int(static_cast<int64_t>(values.size()));
+                for (auto value : values) {
+                    Int(static_cast<int64_t>(value));
+                }
+            }
+            std::string data;
+    };
+
+    /**
+     * @brief Reader of index. Truncated or corrupted index sets failed flag instead of throwing
+     */
+    class IndexReader {
+        public:
+            explicit IndexReader(const std::string &data) : data(data), pos(0), failed(false) {
+            }
+            int64_t Int() {
+                int64_t value = 0;
+                if (data.size() - pos < sizeof(value)) {
+                    failed = true;
+                    return 0;
+                }
+                memcpy(&value, data.data() + pos, sizeof(value));
+                pos += sizeof(value);
+                return value;
+            }
+            /// @brief Number of items, each taking at least one byte
+            size_t Count() {
+                int64_t count = Int();
+                if (count < 0 || static_cast<uint64_t>(count) > data.size() - pos) {
+                    failed = true;
+                    return 0;
+                }
+                return static_cast<size_t>(count);
+            }
+            std::string String() {
+                size_t len = Count();
+                std::string value = data.substr(pos, len);
+                pos += len;
+                return value;
+            }
+            void Value(SchemaValue &value) {
+                value.type = static_cast<int>(Int());
+                value.len = static_cast<size_t>(Int());
+                std::string bytes = String();
+                value.bytes.assign(bytes.begin(), bytes.end());
+                value.strings.resize(Count());
+                for (auto &s : value.strings) {
+                    s = String();
+                }
+            }
+            void Attributes(std::vector<AttributeSchema> &attributes) {
+                attributes.resize(Count());
+                for (auto &attribute : attributes) {
+                    attribute.name = String();
+                    Value(attribute.value);
+                }
+            }
+            template <class T> void Ints(std::vector<T> &values) {
+                values.resize(Count());
+                for (auto &value : values) {
+                    value = static_cast<T>(Int());
+                }
+            }
+            bool Failed() const {
+                return failed || pos != data.size();
+            }
+        private:
+            const std::string &data;
+            size_t pos;
+            bool failed;
+    };
+
+    static void write_variable(IndexWriter &writer, const VariableSchema &variable) {
+        writer.Int(variable.id);
+        writer.String(variable.name);
+        writer.Int(variable.type);
+        writer.Ints(variable.dimids);
+        writer.Int(static_cast<int64_t>(variable.dim_names.size()));
+        for (auto &name : variable.dim_names) {
+            writer.String(name);
+        }
+        writer.Ints(variable.shape);
+        writer.Int(variable.storage);
+        writer.Ints(variable.chunks);
+        writer.Int(variable.shuffle);
+        writer.Int(variable.deflate);
+        writer.Int(variable.deflate_level);
+        writer.Int(variable.has_fill);
+        writer.Int(variable.no_fill);
+        writer.Value(variable.fill);
+        writer.Attributes(variable.attributes);
+    }
+
+    static void read_variable(IndexReader &reader, VariableSchema &variable) {
+        variable.id = static_cast<int>(reader.Int());
+        variable.name = reader.String();
+        variable.type = static_cast<int>(reader.Int());
+        reader.Ints(variable.dimids);
+        variable.dim_names.resize(reader.Count());
+        for (auto &name : variable.dim_names) {
+            name = reader.String();
+        }
+        reader.Ints(variable.shape);
+        variable.storage = static_cast<int>(reader.Int());
+        reader.Ints(variable.chunks);
+        variable.shuffle = reader.Int() != 0;
+        variable.deflate = reader.Int() != 0;
+        variable.deflate_level = static_cast<int>(reader.Int());
+        variable.has_fill = reader.Int() != 0;
+        variable.no_fill = static_cast<int>(reader.Int());
+        reader.Value(variable.fill);
+        reader.Attributes(variable.attributes);
+    }
+
+    /**
+     * @brief Group ids are kept without file part, as file gets other ncid each time it is opened
+     */
+    static void write_group(IndexWriter &writer, const GroupSchema &group) {
+        writer.Int(group.id & 0xFFFF);
+        writer.String(group.name);
+        writer.Int(static_cast<int64_t>(group.dimensions.size()));
+        for (auto &dimension : group.dimensions) {
+            writer.Int(dimension.id);
+            writer.String(dimension.name);
+            writer.Int(static_cast<int64_t>(dimension.len));
+        }
+        writer.Int(static_cast<int64_t>(group.variables.size()));
+        for (auto &it : group.variables) {
+            write_variable(writer, *it.second);
+        }
+        writer.Int(static_cast<int64_t>(group.subgroups.size()));
+        for (auto subgroup : group.subgroups) {
+            writer.Int(subgroup & 0xFFFF);
+        }
+        writer.Attributes(group.attributes);
+    }
+
+    static void read_group(IndexReader &reader, int file_id, GroupSchema &group) {
+        group.id = file_id | static_cast<int>(reader.Int());
+        group.name = reader.String();
+        group.dimensions.resize(reader.Count());
+        for (auto &dimension : group.dimensions) {
+            dimension.id = static_cast<int>(reader.Int());
+            dimension.name = reader.String();
+            dimension.len = static_cast<size_t>(reader.Int());
+        }
+        size_t nvars = reader.Count();
+        for (size_t i = 0; i < nvars; i++) {
+            auto variable = std::make_shared<VariableSchema>();
+            read_variable(reader, *variable);
+            group.variables[variable->id] = variable;
+        }
+        group.subgroups.resize(reader.Count());
+        for (auto &subgroup : group.subgroups) {
+            subgroup = file_id | static_cast<int>(reader.Int());
+        }
+        reader.Attributes(group.attributes);
+    }
+
+    static void write_header(IndexWriter &writer, const std::vector<int64_t> &key) {
+        writer.String(index_magic);
+        writer.Int(index_byte_order);
+        writer.Ints(key);
+    }
+
+    static bool read_file(const std::string &path, std::string &data) {
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == NULL) {
+            return false;
+        }
+        char buffer[65536];
+        size_t len;
+        while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            data.append(buffer, len);
+        }
+        bool ok = ferror(file) == 0;
+        fclose(file);
+        return ok;
+    }
+
+    /**
+     * @brief FNV-1a hash of path
+     */
+    static uint64_t path_hash(const std::string &path) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : path) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::string metadata_index_path(const std::string &path, const std::string &dir) {
+        if (dir.empty()) {
+            return path + ".ncindex";
+        }
+        char resolved[PATH_MAX];
+        std::string absolute = realpath(path.c_str(), resolved) == NULL ? path : std::string(resolved);
+        return string_format("%s/%016llx.ncindex", dir.c_str(), static_cast<unsigned long long>(path_hash(absolute)));
+    }
+
+    bool open_from_index(const std::string &path, const std::string &index, int &id, int &format, std::string &root_name) {
+        std::vector<int64_t> key;
+        std::string data;
+        if (!file_identity(path, key) || !read_file(index, data)) {
+            metadata_index_misses++;
+            return false;
+        }
+        IndexWriter header;
+        write_header(header, key);
+        if (data.compare(0, header.data.size(), header.data) != 0) {
+            metadata_index_misses++;
+            return false;
+        }
+        if (open_placeholder(&id) != NC_NOERR) {
+            metadata_index_misses++;
+            return false;
+        }
+        std::string body = data.substr(header.data.size());
+        IndexReader reader(body);
+        format = static_cast<int>(reader.Int());
+        auto file = std::make_shared<FileSchema>();
+        std::vector<int> unlimited;
+        reader.Ints(unlimited);
+        file->unlimited.insert(unlimited.begin(), unlimited.end());
+        size_t ngroups = reader.Count();
+        for (size_t i = 0; i < ngroups; i++) {
+            auto group = std::make_shared<GroupSchema>();
+            read_group(reader, id, *group);
+            file->groups[group->id] = group;
+        }
+        auto root = file->groups.find(id);
+        if (reader.Failed() || root == file->groups.end()) {
+            nc_close(id);
+            metadata_index_misses++;
+            return false;
+        }
+        root_name = root->second->name;
+        SchemaRegistry::Instance().Adopt(id, file);
+        metadata_index_hits++;
+        return true;
+    }
+
+    void write_metadata_index(const std::string &path, const std::string &index, int id, int format) {
+        std::vector<int64_t> key;
+        auto file = SchemaRegistry::Instance().Find(id);
+        if (!file || !file_identity(path, key)) {
+            return;
+        }
+        IndexWriter writer;
+        write_header(writer, key);
+        writer.Int(format);
+        writer.Ints(std::vector<int>(file->unlimited.begin(), file->unlimited.end()));
+        writer.Int(static_cast<int64_t>(file->groups.size()));
+        for (auto &it : file->groups) {
+            write_group(writer, *it.second);
+        }
+        // Readers never see partially written index
+        std::string tmp = string_format("%s.%d.tmp", index.c_str(), static_cast<int>(getpid()));
+        FILE *out = fopen(tmp.c_str(), "wb");
+        if (out == NULL) {
+            return;
+        }
+        bool ok = fwrite(writer.data.data(), 1, writer.data.size(), out) == writer.data.size();
+        ok = fclose(out) == 0 && ok;
+        if (!ok || rename(tmp.c_str(), index.c_str()) != 0) {
+            remove(tmp.c_str());
+        }
+    }
+
+    /**
+     * @brief libnetcdf gives new file lowest free ncid slot. Slots below placeholder freed meanwhile
+     * are filled with other placeholders, so file lands exactly in slot of closed placeholder
+     */
+    void replace_placeholder(int id, const std::function<int(int *)> &open) {
+        std::vector<int> fillers;
+        int retval = nc_close(id);
+        if (retval != NC_NOERR) {
+            throw std::runtime_error(string_format("NetCDF4: %s", nc_strerror(retval)));
+        }
+        int slot = -1;
+        while ((retval = open_placeholder(&slot)) == NC_NOERR && slot < id) {
+            fillers.push_back(slot);
+        }
+        std::string error;
+        if (retval == NC_NOERR) {
+            nc_close(slot);
+            int real = -1;
+            if (slot != id) {
+                error = "NetCDF4: Can't reserve file id";
+            }
+            else if ((retval = open(&real)) != NC_NOERR) {
+                error = string_format("NetCDF4: %s", nc_strerror(retval));
+            }
+            else if (real != id) {
+                nc_close(real);
+                error = "NetCDF4: Can't reserve file id";
+            }
+        }
+        else {
+            error = string_format("NetCDF4: %s", nc_strerror(retval));
+        }
+        if (!error.empty()) {
+            // Keep slot reserved, so next operation could try again
+            open_placeholder(&slot);
+        }
+        for (auto filler : fillers) {
+            nc_close(filler);
+        }
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+        metadata_index_deferred_opens++;
+    }
+
+}
@@ -0,0 +1,68 @@
+#ifndef NETCDF4_METADATA_INDEX_H
+#define NETCDF4_METADATA_INDEX_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace netcdf4async {
+
+    /// @brief Number of opens served by metadata index
+    extern std::atomic<uint64_t> metadata_index_hits;
+    /// @brief Number of opens which had to parse file and (re)wrote its index
+    extern std::atomic<uint64_t> metadata_index_misses;
+    /// @brief Number of files opened after open was served by index
+    extern std::atomic<uint64_t> metadata_index_deferred_opens;
+
+    /**
+     * @brief Identity of file contents: device, inode, size and modification time
+     * @param path File path
+     * @param key Identity
+     * @return false if file can't be stat'ed
+     */
+    bool file_identity(const std::string &path, std::vector<int64_t> &key);
+
+    /**
+     * @brief Path of metadata index of file
+     * @param path File path
+     * @param dir Cache directory, empty to keep index next to file
+     * @return `<path>.ncindex` or `<dir>/<hash of absolute path>.ncindex`
+     */
+    std::string metadata_index_path(const std::string &path, const std::string &dir);
+
+    /**
+     * @brief Open file from metadata index without parsing file itself
+     * Index matches if file still has the same device, inode, size and modification time.
+     * On match schema is published for placeholder id, which holds ncid slot until file is really opened
+     * by replace_placeholder. Must be called with netcdf lock held
+     * @param path File path
+     * @param index Index path
+     * @param id Placeholder id
+     * @param format File format
+     * @param root_name Root group name
+     * @return true if file was opened from index
+     */
+    bool open_from_index(const std::string &path, const std::string &index, int &id, int &format, std::string &root_name);
+
+    /**
+     * @brief Save schema of opened file to metadata index. Failures are ignored, as index is only a cache.
+     * Must be called with netcdf lock held
+     * @param path File path
+     * @param index Index path
+     * @param id NetCDF file id
+     * @param format File format
+     */
+    void write_metadata_index(const std::string &path, const std::string &index, int id, int format);
+
+    /**
+     * @brief Open file in ncid slot held by placeholder, so ids of groups and variables built from index stay valid.
+     * Must be called with netcdf lock held. Throws on failure, placeholder is kept then
+     * @param id Placeholder id
+     * @param open Function opening file, returns NetCDF status
+     */
+    void replace_placeholder(int id, const std::function<int(int *)> &open);
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include <netcdf.h>
+#include <string.h>
+#include "netcdf4-async.h"
+#include "async.h"
+#include "MetadataIndex.h"
+#include "ResultCache.h"
+
+namespace netcdf4async {
+
+    ResultCache::ResultCache() : capacity(0), size(0), hits(0), misses(0), evictions(0) {
+    }
+
+    /**
+     * @brief Cache instance
+     * Cache is never destroyed, as other process-wide singletons
+     * @return ResultCache&
+     */
+    ResultCache &ResultCache::Instance() {
+        static ResultCache *cache=new ResultCache();
+        return *cache;
+    }
+
+    /**
+     * @brief Remember file path with identity of its contents
+     * Results of the same path opened after file was replaced or changed get other key,
+     * also when it happened within the same second
+     * @param id NetCDF file id
+     * @param path File path
+     * @param writable File is opened in write mode
+     */
+    void ResultCache::RegisterFile(int id, const std::string &path, bool writable) {
+        FileInfo info;
+        std::vector<int64_t> identity;
+        info.path=path;
+        info.writable=writable;
+        if (file_identity(path, identity)) {
+            info.key=path;
+            for (auto part : identity) {
+                info.key+=string_format("|%lld", static_cast<long long>(part));
+            }
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        files[NC_FILE_ID(id)]=info;
+    }
+
+    void ResultCache::UnregisterFile(int id) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=files.find(NC_FILE_ID(id));
+        if (it == files.end()) {
+            return;
+        }
+        if (it->second.writable) {
+            InvalidatePath(it->second.path);
+        }
+        files.erase(it);
+    }
+
+    void ResultCache::Invalidate(int ncid) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=files.find(NC_FILE_ID(ncid));
+        if (it != files.end()) {
+            InvalidatePath(it->second.path);
+        }
+    }
+
+    /**
+     * @brief Drop entries of path and change its generation. Must be called with lock held
+     * @param path File path
+     */
+    void ResultCache::InvalidatePath(const std::string &path) {
+        generations[path]++;
+        for (auto it=entries.begin(); it != entries.end();) {
+            const std::string &key=std::get<0>(it->first);
+            if (key.compare(0, path.size() + 1, path + "|") == 0) {
+                size -= it->second.data.size();
+                lru.erase(it->second.position);
+                it=entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    bool ResultCache::Enabled() {
+        std::lock_guard<std::mutex> guard(lock);
+        return capacity > 0;
+    }
+
+    bool ResultCache::Generation(int ncid, uint64_t &generation) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=files.find(NC_FILE_ID(ncid));
+        if (it == files.end() || it->second.key.empty()) {
+            return false;
+        }
+        generation=generations[it->second.path];
+        return true;
+    }
+
+    /**
+     * @brief Build entry key. Must be called with lock held
+     * Group is identified by its index in file, as the same group has different ncid in other File objects
+     * @return false if file is not registered or result could not be cached
+     */
+    bool ResultCache::MakeKey(int ncid, int varid, int type, const Hyperslab &slab, Key &key) {
+        auto it=files.find(NC_FILE_ID(ncid));
+        if (it == files.end() || it->second.key.empty() || typeSize(type) == 0) {
+            return false;
+        }
+        key=Key(it->second.key, ncid & 0xFFFF, varid, type, slab.start, slab.count, slab.stride);
+        return true;
+    }
+
+    bool ResultCache::Lookup(int ncid, int varid, const Hyperslab &slab, Item &item) {
+        std::lock_guard<std::mutex> guard(lock);
+        Key key;
+        if (capacity == 0 || !MakeKey(ncid, varid, item.type, slab, key)) {
+            return false;
+        }
+        auto it=entries.find(key);
+        if (it == entries.end()) {
+            misses++;
+            return false;
+        }
+        hits++;
+        lru.splice(lru.begin(), lru, it->second.position);
+        item.len=slab.len;
+        typedValue(&item);
+        memcpy(item.value.v, it->second.data.data(), it->second.data.size());
+        return true;
+    }
+
+    void ResultCache::Insert(int ncid, uint64_t generation, int varid, const Hyperslab &slab, const Item &item) {
+        std::lock_guard<std::mutex> guard(lock);
+        Key key;
+        if (capacity == 0 || !MakeKey(ncid, varid, item.type, slab, key)) {
+            return;
+        }
+        size_t bytes=item.len * typeSize(item.type);
+        if (generations[files[NC_FILE_ID(ncid)].path] != generation || bytes > capacity ||
+            entries.find(key) != entries.end()) {
+            return;
+        }
+        lru.push_front(key);
+        Entry &entry=entries[key];
+        entry.data.assign(static_cast<uint8_t *>(item.value.v), static_cast<uint8_t *>(item.value.v) + bytes);
+        entry.position=lru.begin();
+        size += bytes;
+        Trim();
+    }
+
+    /**
+     * @brief Evict least recently used entries above capacity. Must be called with lock held
+     */
+    void ResultCache::Trim() {
+        while (size > capacity && !lru.empty()) {
+            auto it=entries.find(lru.back());
+            size -= it->second.data.size();
+            entries.erase(it);
+            lru.pop_back();
+            evictions++;
+        }
+    }
+
+    void ResultCache::Resize(size_t bytes) {
+        std::lock_guard<std::mutex> guard(lock);
+        capacity=bytes;
+        Trim();
+    }
+
+    size_t ResultCache::Capacity() {
+        std::lock_guard<std::mutex> guard(lock);
+        return capacity;
+    }
+
+    void ResultCache::Stats(uint64_t &hits, uint64_t &misses, uint64_t &evictions, size_t &size, size_t &entries) {
+        std::lock_guard<std::mutex> guard(lock);
+        hits=this->hits;
+        misses=this->misses;
+        evictions=this->evictions;
+        size=this->size;
+        entries=this->entries.size();
+    }
+
+}
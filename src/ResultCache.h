@@ -0,0 +1,100 @@
+#ifndef NETCDF4_RESULTCACHE_H
+#define NETCDF4_RESULTCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "Macros.h"
+
+namespace netcdf4async {
+
+    /**
+     * @brief Process-wide LRU cache of read results
+     * Results are keyed by file path with identity of its contents, so all File objects
+     * opened on the same unchanged file share them. Cache is disabled until capacity is set.
+     * Entries of a path are invalidated when it is written or closed after opening in write mode.
+     * Reads which were in flight during invalidation do not put their (stale) results into cache.
+     */
+    class ResultCache {
+        public:
+            /// @brief Cache instance
+            /// @return cache
+            static ResultCache &Instance();
+            /// @brief Remember path of opened file
+            /// @param id NetCDF file id
+            /// @param path File path
+            /// @param writable File is opened in write mode
+            void RegisterFile(int id, const std::string &path, bool writable);
+            /// @brief Forget closed file, invalidate its path if it was opened in write mode
+            /// @param id NetCDF file id
+            void UnregisterFile(int id);
+            /// @brief Invalidate entries of file path
+            /// @param ncid NetCDF file or group id
+            void Invalidate(int ncid);
+            /// @brief Is cache enabled
+            bool Enabled();
+            /// @brief Generation of file path, changed on each invalidation
+            /// @param ncid NetCDF file or group id
+            /// @param generation Generation
+            /// @return false if file is not registered
+            bool Generation(int ncid, uint64_t &generation);
+            /// @brief Find result and copy it into new item
+            /// @param ncid NetCDF group id
+            /// @param varid Variable id
+            /// @param slab Hyperslab
+            /// @param item Item with type set, filled on hit
+            /// @return true on hit
+            bool Lookup(int ncid, int varid, const Hyperslab &slab, Item &item);
+            /// @brief Put result into cache if its file was not invalidated since read started
+            /// @param ncid NetCDF group id
+            /// @param generation Generation of file path when read started
+            /// @param varid Variable id
+            /// @param slab Hyperslab
+            /// @param item Result
+            void Insert(int ncid, uint64_t generation, int varid, const Hyperslab &slab, const Item &item);
+            /// @brief Change capacity, extra entries are evicted
+            /// @param bytes New capacity in bytes, 0 disables and clears cache
+            void Resize(size_t bytes);
+            /// @brief Capacity in bytes
+            size_t Capacity();
+            /// @brief Counters
+            /// @param hits Lookups found in cache
+            /// @param misses Lookups not found in cache
+            /// @param evictions Entries evicted to keep cache in capacity
+            /// @param size Size of cached results in bytes
+            /// @param entries Number of cached results
+            void Stats(uint64_t &hits, uint64_t &misses, uint64_t &evictions, size_t &size, size_t &entries);
+        private:
+            typedef std::tuple<std::string, int, int, int, std::vector<size_t>, std::vector<size_t>, std::vector<ptrdiff_t>> Key;
+            struct Entry {
+                std::vector<uint8_t> data;
+                std::list<Key>::iterator position;
+            };
+            struct FileInfo {
+                std::string path;
+                std::string key;
+                bool writable;
+            };
+            ResultCache();
+            bool MakeKey(int ncid, int varid, int type, const Hyperslab &slab, Key &key);
+            void InvalidatePath(const std::string &path);
+            void Trim();
+            std::mutex lock;
+            std::map<int, FileInfo> files;
+            std::map<std::string, uint64_t> generations;
+            std::map<Key, Entry> entries;
+            std::list<Key> lru;
+            size_t capacity;
+            size_t size;
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+    };
+
+}
+
+#endif
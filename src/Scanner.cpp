@@ -0,0 +1,180 @@
+#include "Scanner.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <netcdf.h>
+#include <vector>
+#include "netcdf4-async.h"
+#include "async.h"
+#include "Schema.h"
+
+namespace netcdf4async {
+
+/// @brief HDF5 signature, found at offset 0, 512, 1024, 2048, ... of file
+static const char hdf5_signature[] = "\x89HDF\r\n\x1a\n";
+/// @brief Largest HDF5 user block searched for signature
+static const long max_user_block = 1L << 30;
+/// @brief HDF4 signature
+static const char hdf4_signature[] = "\x0e\x03\x13\x01";
+
+std::string sniff_format(const std::string &path, std::string &error) {
+	FILE *file = fopen(path.c_str(), "rb");
+	if (file == NULL) {
+		error = string_format("Can't open %s: %s", path.c_str(), strerror(errno));
+		return "";
+	}
+	char magic[8];
+	size_t len = fread(magic, 1, sizeof(magic), file);
+	std::string format = "unknown";
+	if (len >= 4 && memcmp(magic, "CDF", 3) == 0 && (magic[3] == 1 || magic[3] == 2 || magic[3] == 5)) {
+		format = NC_FORMATS(NC_FORMATX_NC3);
+	}
+	else if (len >= 4 && memcmp(magic, hdf4_signature, 4) == 0) {
+		format = NC_FORMATS(NC_FORMATX_NC_HDF4);
+	}
+	else {
+		// HDF5 user block shifts superblock to 512, 1024, 2048, ... bytes
+		for (long offset = 0; offset <= max_user_block; offset = offset == 0 ? 512 : offset * 2) {
+			if (offset > 0) {
+				if (fseek(file, offset, SEEK_SET) != 0) {
+					break;
+				}
+				len = fread(magic, 1, sizeof(magic), file);
+			}
+			if (len < sizeof(magic)) {
+				break;
+			}
+			if (memcmp(magic, hdf5_signature, sizeof(magic)) == 0) {
+				format = NC_FORMATS(NC_FORMATX_NC_HDF5);
+				break;
+			}
+		}
+	}
+	fclose(file);
+	return format;
+}
+
+/**
+ * @brief Worker summarizing batch of files
+ * Each file is opened, summarized and closed with netcdf lock held only for that file,
+ * so operations on opened files are not blocked for whole batch.
+ * Summaries are built as one JSON array, so main thread makes single JSON.parse call per batch.
+ */
+class ScanWorker : public AsyncPromiseWorker {
+	public:
+		ScanWorker(Napi::Env &env, Napi::Promise::Deferred deferred, const std::vector<std::string> &paths,
+			const std::vector<std::string> &fields, bool sniff)
+			: AsyncPromiseWorker(env, deferred), paths(paths), fields(fields), sniff(sniff) {
+		}
+	protected:
+		void Execute() override {
+			json = "[";
+			for (size_t i = 0; i < paths.size(); i++) {
+				if (i > 0) {
+					json += ',';
+				}
+				Summarize(paths[i]);
+			}
+			json += ']';
+		}
+		void OnOK() override {
+			Release();
+			Napi::Env env = Env();
+			Napi::Object JSON = env.Global().Get("JSON").As<Napi::Object>();
+			Deferred().Resolve(JSON.Get("parse").As<Napi::Function>().Call(JSON, {Napi::String::New(env, json)}));
+		}
+	private:
+		/**
+		 * @brief Append summary of one file. Failures are reported in summary, they do not fail batch
+		 * @param path File path
+		 */
+		void Summarize(const std::string &path) {
+			std::string summary = "{\"path\":";
+			std::string error;
+			summary += JsonString(path);
+			if (sniff) {
+				std::string format = sniff_format(path, error);
+				json += summary + (error.empty() ? ",\"format\":" + JsonString(format) : ",\"error\":" + JsonString(error)) + '}';
+				return;
+			}
+			bool recursive = false;
+			for (auto &field : fields) {
+				recursive = recursive || field == "groups";
+			}
+			std::lock_guard<std::mutex> lock(netcdf_lock());
+			int id, format;
+			int retval = nc_open(path.c_str(), NC_NOWRITE, &id);
+			if (retval != NC_NOERR) {
+				json += summary + ",\"error\":" + JsonString(string_format("NetCDF4: %s", nc_strerror(retval))) + '}';
+				return;
+			}
+			FileSchema schema;
+			if ((retval = nc_inq_format_extended(id, &format, NULL)) == NC_NOERR &&
+				(fields.empty() || (retval = loadSchema(id, schema, recursive)) == NC_NOERR)) {
+				summary += ",\"format\":" + JsonString(NC_FORMATS(format));
+				for (auto &field : fields) {
+					summary += ',' + JsonString(field) + ':';
+					describeSection(schema, id, field, summary);
+				}
+			}
+			nc_close(id);
+			if (retval != NC_NOERR) {
+				summary += ",\"error\":" + JsonString(string_format("NetCDF4: %s", nc_strerror(retval)));
+			}
+			json += summary + '}';
+		}
+		static std::string JsonString(const std::string &value) {
+			std::string json;
+			jsonString(value, json);
+			return json;
+		}
+		std::vector<std::string> paths;
+		std::vector<std::string> fields;
+		bool sniff;
+		std::string json;
+};
+
+Napi::Value scan_batch(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+	if (info.Length() < 1 || !info[0].IsArray()) {
+		deferred.Reject(Napi::String::New(env, "Expecting an array of paths"));
+		return deferred.Promise();
+	}
+	std::vector<std::string> paths;
+	Napi::Array paths_array = info[0].As<Napi::Array>();
+	for (uint32_t i = 0; i < paths_array.Length(); i++) {
+		paths.push_back(paths_array.Get(i).ToString().Utf8Value());
+	}
+	std::vector<std::string> fields{"dimensions", "variables", "attributes"};
+	bool sniff = false;
+	if (info.Length() > 1 && info[1].IsObject()) {
+		Napi::Object options = info[1].As<Napi::Object>();
+		sniff = options.Get("sniff").ToBoolean().Value();
+		Napi::Value fields_value = options.Get("fields");
+		if (fields_value.IsArray()) {
+			Napi::Array fields_array = fields_value.As<Napi::Array>();
+			fields.clear();
+			for (uint32_t i = 0; i < fields_array.Length(); i++) {
+				std::string field = fields_array.Get(i).ToString().Utf8Value();
+				bool known = false;
+				for (auto section : describe_sections) {
+					known = known || field == section;
+				}
+				if (!known) {
+					deferred.Reject(Napi::String::New(env, string_format("Unknown field %s", field.c_str())));
+					return deferred.Promise();
+				}
+				fields.push_back(field);
+			}
+		}
+		else if (!fields_value.IsUndefined()) {
+			deferred.Reject(Napi::String::New(env, "fields must be an array"));
+			return deferred.Promise();
+		}
+	}
+	(new ScanWorker(env, deferred, paths, fields, sniff))->Queue();
+	return deferred.Promise();
+}
+
+}
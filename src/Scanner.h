@@ -0,0 +1,21 @@
+#ifndef NETCDF4_SCANNER_H
+#define NETCDF4_SCANNER_H
+
+#include <napi.h>
+#include <string>
+
+namespace netcdf4async {
+
+/// @brief Summarize batch of files in one worker
+/// @param info NodeJS params: array of paths, options `{fields, sniff}`
+/// @return Promise resolved to array of summaries `{path, format, ...fields}` or `{path, error}`
+Napi::Value scan_batch(const Napi::CallbackInfo &info);
+/// @brief Detect file format from magic bytes without opening file with libnetcdf
+/// @param path File path
+/// @param error Error message if file could not be read
+/// @return Format name as in File.format, `unknown` if file is not recognized
+std::string sniff_format(const std::string &path, std::string &error);
+
+}
+
+#endif
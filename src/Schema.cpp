@@ -0,0 +1,648 @@
+#include <netcdf.h>
+#include <string.h>
+#include <cmath>
+#include "netcdf4-async.h"
+#include "async.h"
+#include "Macros.h"
+#include "Schema.h"
+
+namespace netcdf4async {
+
+    /**
+     * @brief Read attribute value
+     * @return false if attribute type is not supported, so attribute is skipped
+     */
+    static bool load_value(int ncid, int varid, const char *name, int type, size_t len, SchemaValue &value, int &retval) {
+        value.type=type;
+        value.len=len;
+        if (type == NC_STRING) {
+            std::vector<char *> strings(len);
+            retval=nc_get_att(ncid, varid, name, strings.data());
+            if (retval == NC_NOERR) {
+                for (auto s : strings) {
+                    value.strings.push_back(s == NULL ? "" : s);
+                }
+                nc_free_string(len, strings.data());
+            }
+            return true;
+        }
+        if (typeSize(type) == 0) {
+            return false;
+        }
+        value.bytes.resize(len * typeSize(type));
+        retval=nc_get_att(ncid, varid, name, value.bytes.data());
+        return true;
+    }
+
+    static int load_attributes(int ncid, int varid, int natts, std::vector<AttributeSchema> &attributes) {
+        char name[NC_MAX_NAME + 1];
+        for (int i = 0; i < natts; i++) {
+            int type;
+            size_t len;
+            int retval;
+            if ((retval=nc_inq_attname(ncid, varid, i, name)) != NC_NOERR ||
+                (retval=nc_inq_att(ncid, varid, name, &type, &len)) != NC_NOERR) {
+                return retval;
+            }
+            AttributeSchema attribute;
+            attribute.name=name;
+            if (load_value(ncid, varid, name, type, len, attribute.value, retval)) {
+                if (retval != NC_NOERR) {
+                    return retval;
+                }
+                attributes.push_back(attribute);
+            }
+        }
+        return NC_NOERR;
+    }
+
+    /**
+     * @brief Read fill value of variable. Variables of user defined types have no fill in schema
+     */
+    static int load_fill(int ncid, int varid, VariableSchema &variable) {
+        variable.fill.type=variable.type;
+        variable.fill.len=1;
+        variable.has_fill=true;
+        if (variable.type == NC_STRING) {
+            char *fill=NULL;
+            int retval=nc_inq_var_fill(ncid, varid, &variable.no_fill, &fill);
+            if (retval == NC_NOERR) {
+                variable.fill.strings.push_back(fill == NULL ? "" : fill);
+                if (fill != NULL) {
+                    nc_free_string(1, &fill);
+                }
+            }
+            return retval;
+        }
+        if (typeSize(variable.type) == 0) {
+            variable.has_fill=false;
+            return NC_NOERR;
+        }
+        variable.fill.bytes.resize(typeSize(variable.type));
+        return nc_inq_var_fill(ncid, varid, &variable.no_fill, variable.fill.bytes.data());
+    }
+
+    static int load_variable(int ncid, int varid, VariableSchema &variable) {
+        char name[NC_MAX_NAME + 1];
+        int ndims, natts, retval;
+        nc_type type;
+        if ((retval=nc_inq_var(ncid, varid, name, &type, &ndims, NULL, &natts)) != NC_NOERR) {
+            return retval;
+        }
+        variable.id=varid;
+        variable.name=name;
+        variable.type=type;
+        variable.dimids.resize(ndims);
+        if ((retval=nc_inq_vardimid(ncid, varid, variable.dimids.data())) != NC_NOERR) {
+            return retval;
+        }
+        for (int i = 0; i < ndims; i++) {
+            size_t len;
+            if ((retval=nc_inq_dim(ncid, variable.dimids[i], name, &len)) != NC_NOERR) {
+                return retval;
+            }
+            variable.dim_names.push_back(name);
+            variable.shape.push_back(len);
+        }
+        variable.chunks.assign(ndims, 0);
+        if (nc_inq_var_chunking(ncid, varid, &variable.storage, variable.chunks.data()) != NC_NOERR) {
+            variable.storage=NC_CONTIGUOUS;
+        }
+        int shuffle=0, deflate=0;
+        variable.deflate_level=0;
+        if (nc_inq_var_deflate(ncid, varid, &shuffle, &deflate, &variable.deflate_level) != NC_NOERR) {
+            shuffle=deflate=variable.deflate_level=0;
+        }
+        variable.shuffle=shuffle != 0;
+        variable.deflate=deflate != 0;
+        if ((retval=load_fill(ncid, varid, variable)) != NC_NOERR) {
+            return retval;
+        }
+        return load_attributes(ncid, varid, natts, variable.attributes);
+    }
+
+    /**
+     * @brief Read group metadata except variables
+     */
+    static int load_group_header(int ncid, GroupSchema &group, std::set<int> &unlimited) {
+        char name[NC_MAX_NAME + 1];
+        int ndims, ngrps, natts, retval;
+        if ((retval=nc_inq_grpname(ncid, name)) != NC_NOERR) {
+            return retval;
+        }
+        group.id=ncid;
+        group.name=name;
+        if ((retval=nc_inq_dimids(ncid, &ndims, NULL, 0)) != NC_NOERR) {
+            return retval;
+        }
+        std::vector<int> dimids(ndims);
+        if ((retval=nc_inq_dimids(ncid, NULL, dimids.data(), 0)) != NC_NOERR) {
+            return retval;
+        }
+        for (auto dimid : dimids) {
+            DimensionSchema dimension;
+            dimension.id=dimid;
+            if ((retval=nc_inq_dim(ncid, dimid, name, &dimension.len)) != NC_NOERR) {
+                return retval;
+            }
+            dimension.name=name;
+            group.dimensions.push_back(dimension);
+        }
+        int nunlimited;
+        if ((retval=nc_inq_unlimdims(ncid, &nunlimited, NULL)) != NC_NOERR) {
+            return retval;
+        }
+        std::vector<int> unlimited_ids(nunlimited);
+        if ((retval=nc_inq_unlimdims(ncid, NULL, unlimited_ids.data())) != NC_NOERR) {
+            return retval;
+        }
+        unlimited.insert(unlimited_ids.begin(), unlimited_ids.end());
+        if ((retval=nc_inq_grps(ncid, &ngrps, NULL)) != NC_NOERR) {
+            return retval;
+        }
+        group.subgroups.resize(ngrps);
+        if ((retval=nc_inq_grps(ncid, NULL, group.subgroups.data())) != NC_NOERR ||
+            (retval=nc_inq_natts(ncid, &natts)) != NC_NOERR) {
+            return retval;
+        }
+        return load_attributes(ncid, NC_GLOBAL, natts, group.attributes);
+    }
+
+    /**
+     * @brief Read group with its variables and all subgroups missing in schema
+     */
+    static int load_tree(int ncid, FileSchema &file, bool recursive) {
+        auto group=std::make_shared<GroupSchema>();
+        int nvars, retval;
+        if ((retval=load_group_header(ncid, *group, file.unlimited)) != NC_NOERR ||
+            (retval=nc_inq_varids(ncid, &nvars, NULL)) != NC_NOERR) {
+            return retval;
+        }
+        std::vector<int> varids(nvars);
+        if ((retval=nc_inq_varids(ncid, NULL, varids.data())) != NC_NOERR) {
+            return retval;
+        }
+        for (auto varid : varids) {
+            auto variable=std::make_shared<VariableSchema>();
+            if ((retval=load_variable(ncid, varid, *variable)) != NC_NOERR) {
+                return retval;
+            }
+            group->variables[varid]=variable;
+        }
+        file.groups[ncid]=group;
+        for (auto subgroup : group->subgroups) {
+            if (recursive && file.groups.find(subgroup) == file.groups.end() && (retval=load_tree(subgroup, file, true)) != NC_NOERR) {
+                return retval;
+            }
+        }
+        return NC_NOERR;
+    }
+
+    int loadSchema(int id, FileSchema &file, bool recursive) {
+        return load_tree(id, file, recursive);
+    }
+
+    /**
+     * @brief Registry instance
+     * Registry is never destroyed, as other process-wide singletons
+     * @return SchemaRegistry&
+     */
+    SchemaRegistry &SchemaRegistry::Instance() {
+        static SchemaRegistry *registry=new SchemaRegistry();
+        return *registry;
+    }
+
+    int SchemaRegistry::Load(int id) {
+        auto file=std::make_shared<FileSchema>();
+        int retval=loadSchema(id, *file);
+        if (retval == NC_NOERR) {
+            std::lock_guard<std::mutex> guard(lock);
+            files[NC_FILE_ID(id)]=file;
+        }
+        return retval;
+    }
+
+    void SchemaRegistry::Adopt(int id, std::shared_ptr<const FileSchema> schema) {
+        std::lock_guard<std::mutex> guard(lock);
+        files[NC_FILE_ID(id)]=schema;
+    }
+
+    void SchemaRegistry::Remove(int id) {
+        std::lock_guard<std::mutex> guard(lock);
+        files.erase(NC_FILE_ID(id));
+    }
+
+    std::shared_ptr<const FileSchema> SchemaRegistry::Find(int ncid) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=files.find(NC_FILE_ID(ncid));
+        return it == files.end() ? nullptr : it->second;
+    }
+
+    /**
+     * @brief Replace schema of file, unless file was closed meanwhile
+     */
+    void SchemaRegistry::Publish(int ncid, std::shared_ptr<const FileSchema> schema) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=files.find(NC_FILE_ID(ncid));
+        if (it != files.end()) {
+            it->second=schema;
+        }
+    }
+
+    /**
+     * @brief Reload group header. Schema of failed group is dropped, so stale data are never returned
+     * @param ncid NetCDF group id
+     */
+    void SchemaRegistry::RefreshGroup(int ncid) {
+        auto current=Find(ncid);
+        if (!current) {
+            return;
+        }
+        auto next=std::make_shared<FileSchema>(*current);
+        auto group=std::make_shared<GroupSchema>();
+        if (load_group_header(ncid, *group, next->unlimited) != NC_NOERR) {
+            Remove(ncid);
+            return;
+        }
+        auto it=current->groups.find(ncid);
+        if (it != current->groups.end()) {
+            group->variables=it->second->variables;
+        }
+        next->groups[ncid]=group;
+        for (auto subgroup : group->subgroups) {
+            if (next->groups.find(subgroup) == next->groups.end() && load_tree(subgroup, *next, true) != NC_NOERR) {
+                Remove(ncid);
+                return;
+            }
+        }
+        Publish(ncid, next);
+    }
+
+    void SchemaRegistry::RefreshVariable(int ncid, int varid) {
+        if (varid == NC_GLOBAL) {
+            RefreshGroup(ncid);
+            return;
+        }
+        auto current=Find(ncid);
+        if (!current) {
+            return;
+        }
+        auto it=current->groups.find(ncid);
+        auto variable=std::make_shared<VariableSchema>();
+        if (it == current->groups.end() || load_variable(ncid, varid, *variable) != NC_NOERR) {
+            Remove(ncid);
+            return;
+        }
+        auto next=std::make_shared<FileSchema>(*current);
+        auto group=std::make_shared<GroupSchema>(*it->second);
+        group->variables[varid]=variable;
+        next->groups[ncid]=group;
+        Publish(ncid, next);
+    }
+
+    /**
+     * @brief Update shape of written variable and lengths of its unlimited dimensions
+     * Only the variable and groups defining its unlimited dimensions are read, so cost of write
+     * does not depend on number of variables. Shapes of other variables using the same dimensions
+     * are updated by their own writes. Nothing is read for files without unlimited dimensions
+     * @param ncid NetCDF group id
+     * @param varid Written variable id
+     */
+    void SchemaRegistry::RefreshLengths(int ncid, int varid) {
+        auto current=Find(ncid);
+        if (!current || current->unlimited.empty()) {
+            return;
+        }
+        auto group_it=current->groups.find(ncid);
+        if (group_it == current->groups.end()) {
+            return;
+        }
+        auto var_it=group_it->second->variables.find(varid);
+        if (var_it == group_it->second->variables.end()) {
+            return;
+        }
+        const VariableSchema &old_variable=*var_it->second;
+        std::map<int, size_t> lengths;
+        std::shared_ptr<VariableSchema> variable;
+        for (size_t i = 0; i < old_variable.dimids.size(); i++) {
+            int dimid=old_variable.dimids[i];
+            if (current->unlimited.count(dimid) == 0) {
+                continue;
+            }
+            auto known=lengths.find(dimid);
+            size_t len;
+            if (known != lengths.end()) {
+                len=known->second;
+            }
+            else if (nc_inq_dimlen(ncid, dimid, &len) == NC_NOERR) {
+                lengths[dimid]=len;
+            }
+            else {
+                continue;
+            }
+            if (len != old_variable.shape[i]) {
+                if (!variable) {
+                    variable=std::make_shared<VariableSchema>(old_variable);
+                }
+                variable->shape[i]=len;
+            }
+        }
+        std::map<int, std::shared_ptr<GroupSchema>> changed;
+        if (variable) {
+            changed[ncid]=std::make_shared<GroupSchema>(*group_it->second);
+            changed[ncid]->variables[varid]=variable;
+        }
+        // Dimension is listed by group which defines it, the same group or its ancestor
+        for (auto &length : lengths) {
+            int gid=ncid;
+            while (true) {
+                auto it=current->groups.find(gid);
+                if (it == current->groups.end()) {
+                    break;
+                }
+                const GroupSchema &old_group=changed.count(gid) ? *changed[gid] : *it->second;
+                size_t i=0;
+                while (i < old_group.dimensions.size() && old_group.dimensions[i].id != length.first) {
+                    i++;
+                }
+                if (i < old_group.dimensions.size()) {
+                    if (old_group.dimensions[i].len != length.second) {
+                        if (!changed.count(gid)) {
+                            changed[gid]=std::make_shared<GroupSchema>(old_group);
+                        }
+                        changed[gid]->dimensions[i].len=length.second;
+                    }
+                    break;
+                }
+                if (nc_inq_grp_parent(gid, &gid) != NC_NOERR) {
+                    break;
+                }
+            }
+        }
+        if (changed.empty()) {
+            return;
+        }
+        auto next=std::make_shared<FileSchema>(*current);
+        for (auto &group : changed) {
+            next->groups[group.first]=group.second;
+        }
+        Publish(ncid, next);
+    }
+
+    void jsonString(const std::string &value, std::string &json) {
+        json += '"';
+        for (unsigned char c : value) {
+            if (c == '"' || c == '\\') {
+                json += '\\';
+                json += static_cast<char>(c);
+            }
+            else if (c < 0x20) {
+                json += string_format("\\u%04x", c);
+            }
+            else {
+                json += static_cast<char>(c);
+            }
+        }
+        json += '"';
+    }
+
+    /**
+     * @brief One number of value. Not finite floating point numbers have no JSON form, so they become null
+     */
+    static void json_number(const SchemaValue &value, size_t i, std::string &json) {
+        const uint8_t *data=value.bytes.data() + i * typeSize(value.type);
+        double d;
+        switch (value.type) {
+        case NC_BYTE: json += std::to_string(*reinterpret_cast<const int8_t *>(data)); return;
+        case NC_UBYTE: json += std::to_string(*data); return;
+        case NC_SHORT: json += std::to_string(*reinterpret_cast<const int16_t *>(data)); return;
+        case NC_USHORT: json += std::to_string(*reinterpret_cast<const uint16_t *>(data)); return;
+        case NC_INT: json += std::to_string(*reinterpret_cast<const int32_t *>(data)); return;
+        case NC_UINT: json += std::to_string(*reinterpret_cast<const uint32_t *>(data)); return;
+        case NC_INT64: json += std::to_string(*reinterpret_cast<const int64_t *>(data)); return;
+        case NC_UINT64: json += std::to_string(*reinterpret_cast<const uint64_t *>(data)); return;
+        case NC_FLOAT:
+            d=*reinterpret_cast<const float *>(data);
+            json += std::isfinite(d) ? string_format("%.9g", d) : "null";
+            return;
+        default:
+            d=*reinterpret_cast<const double *>(data);
+            json += std::isfinite(d) ? string_format("%.17g", d) : "null";
+        }
+    }
+
+    /**
+     * @brief Value as number or string for single value, array otherwise. Char values are one string
+     */
+    static void json_value(const SchemaValue &value, std::string &json) {
+        if (value.type == NC_CHAR) {
+            jsonString(std::string(reinterpret_cast<const char *>(value.bytes.data()), strnlen(reinterpret_cast<const char *>(value.bytes.data()), value.bytes.size())), json);
+            return;
+        }
+        size_t len=value.type == NC_STRING ? value.strings.size() : value.len;
+        if (len != 1) {
+            json += '[';
+        }
+        for (size_t i = 0; i < len; i++) {
+            if (i > 0) {
+                json += ',';
+            }
+            if (value.type == NC_STRING) {
+                jsonString(value.strings[i], json);
+            }
+            else {
+                json_number(value, i, json);
+            }
+        }
+        if (len != 1) {
+            json += ']';
+        }
+    }
+
+    static void json_attributes(const std::vector<AttributeSchema> &attributes, std::string &json) {
+        json += '{';
+        for (size_t i = 0; i < attributes.size(); i++) {
+            if (i > 0) {
+                json += ',';
+            }
+            jsonString(attributes[i].name, json);
+            json += ":{\"type\":";
+            jsonString(get_type_string(attributes[i].value.type), json);
+            json += ",\"value\":";
+            json_value(attributes[i].value, json);
+            json += '}';
+        }
+        json += '}';
+    }
+
+    template <typename T> static void json_array(const std::vector<T> &values, std::string &json) {
+        json += '[';
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i > 0) {
+                json += ',';
+            }
+            json += std::to_string(values[i]);
+        }
+        json += ']';
+    }
+
+    static void json_variable(const VariableSchema &variable, std::string &json) {
+        json += "{\"type\":";
+        jsonString(get_type_string(variable.type), json);
+        json += ",\"dimensions\":[";
+        for (size_t i = 0; i < variable.dim_names.size(); i++) {
+            if (i > 0) {
+                json += ',';
+            }
+            jsonString(variable.dim_names[i], json);
+        }
+        json += "],\"shape\":";
+        json_array(variable.shape, json);
+        json += ",\"storage\":";
+        std::string storage=variable.storage == NC_CHUNKED ? "chunked" : variable.storage == NC_CONTIGUOUS ? "contiguous" : "unknown";
+#ifdef NC_COMPACT
+        if (variable.storage == NC_COMPACT) {
+            storage="compact";
+        }
+#endif
+        jsonString(storage, json);
+        if (variable.storage == NC_CHUNKED) {
+            json += ",\"chunks\":";
+            json_array(variable.chunks, json);
+        }
+        json += string_format(",\"shuffle\":%s,\"deflate\":%s,\"deflateLevel\":%d",
+            variable.shuffle ? "true" : "false", variable.deflate ? "true" : "false", variable.deflate_level);
+        json += ",\"fill\":";
+        if (variable.has_fill && variable.no_fill == 0) {
+            json_value(variable.fill, json);
+        }
+        else {
+            json += "null";
+        }
+        json += ",\"attributes\":";
+        json_attributes(variable.attributes, json);
+        json += '}';
+    }
+
+    /// @brief Sections of described group, in output order
+    const char *describe_sections[]={"dimensions", "unlimited", "attributes", "variables", "groups"};
+
+    /**
+     * @brief Dimension lengths are actual lengths, unlimited dimensions are listed separately
+     */
+    void describeSection(const FileSchema &file, int ncid, const std::string &section, std::string &json) {
+        const GroupSchema &group=*file.groups.at(ncid);
+        bool first=true;
+        if (section == "dimensions") {
+            json += '{';
+            for (auto &dimension : group.dimensions) {
+                if (!first) {
+                    json += ',';
+                }
+                first=false;
+                jsonString(dimension.name, json);
+                json += ':' + std::to_string(dimension.len);
+            }
+            json += '}';
+        }
+        else if (section == "unlimited") {
+            json += '[';
+            for (auto &dimension : group.dimensions) {
+                if (file.unlimited.count(dimension.id) == 0) {
+                    continue;
+                }
+                if (!first) {
+                    json += ',';
+                }
+                first=false;
+                jsonString(dimension.name, json);
+            }
+            json += ']';
+        }
+        else if (section == "attributes") {
+            json_attributes(group.attributes, json);
+        }
+        else if (section == "variables") {
+            json += '{';
+            for (auto &entry : group.variables) {
+                if (!first) {
+                    json += ',';
+                }
+                first=false;
+                jsonString(entry.second->name, json);
+                json += ':';
+                json_variable(*entry.second, json);
+            }
+            json += '}';
+        }
+        else if (section == "groups") {
+            json += '{';
+            for (auto subgroup : group.subgroups) {
+                auto it=file.groups.find(subgroup);
+                if (it == file.groups.end()) {
+                    continue;
+                }
+                if (!first) {
+                    json += ',';
+                }
+                first=false;
+                jsonString(it->second->name, json);
+                json += ':';
+                describeGroup(file, subgroup, json);
+            }
+            json += '}';
+        }
+        else {
+            json += "null";
+        }
+    }
+
+    void describeGroup(const FileSchema &file, int ncid, std::string &json) {
+        json += "{\"name\":";
+        jsonString(file.groups.at(ncid)->name, json);
+        for (auto section : describe_sections) {
+            json += ",\"" + std::string(section) + "\":";
+            describeSection(file, ncid, section, json);
+        }
+        json += '}';
+    }
+
+    Napi::Value schemaValue(Napi::Env env, const SchemaValue &value) {
+        Item item;
+        item.type=value.type;
+        item.len=value.len;
+        if (value.type == NC_STRING) {
+            std::vector<char *> strings;
+            for (auto &s : value.strings) {
+                strings.push_back(const_cast<char *>(s.c_str()));
+            }
+            item.value.ps=strings.data();
+            return item2value(env, &item);
+        }
+        typedValue(&item);
+        if (!value.bytes.empty()) {
+            memcpy(item.value.v, value.bytes.data(), value.bytes.size());
+        }
+        return item2value(env, &item);
+    }
+
+    Napi::Value dimensionLength(Napi::Env env, size_t len) {
+        if (len == NC_UNLIMITED) {
+            return Napi::String::New(env, "unlimited");
+        }
+        return Napi::Number::New(env, static_cast<double>(len));
+    }
+
+    const GroupSchema &findGroupSchema(Napi::Env env, int ncid, std::shared_ptr<const FileSchema> &file) {
+        file=SchemaRegistry::Instance().Find(ncid);
+        if (!file) {
+            throw Napi::Error::New(env, "NetCDF4: Schema is not loaded");
+        }
+        auto it=file->groups.find(ncid);
+        if (it == file->groups.end()) {
+            throw Napi::Error::New(env, "NetCDF4: Group not found in schema");
+        }
+        return *it->second;
+    }
+
+}
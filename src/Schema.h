@@ -0,0 +1,156 @@
+#ifndef NETCDF4_SCHEMA_H
+#define NETCDF4_SCHEMA_H
+
+#include <napi.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace netcdf4async {
+
+    /// @brief Attribute or fill value kept in schema
+    struct SchemaValue {
+        int type;
+        size_t len;
+        /// @brief Raw values of numeric and char types
+        std::vector<uint8_t> bytes;
+        /// @brief Values of string type
+        std::vector<std::string> strings;
+    };
+
+    struct AttributeSchema {
+        std::string name;
+        SchemaValue value;
+    };
+
+    struct DimensionSchema {
+        int id;
+        std::string name;
+        size_t len;
+    };
+
+    struct VariableSchema {
+        int id;
+        std::string name;
+        int type;
+        std::vector<int> dimids;
+        std::vector<std::string> dim_names;
+        std::vector<size_t> shape;
+        /// @brief NC_CONTIGUOUS, NC_CHUNKED, ...
+        int storage;
+        std::vector<size_t> chunks;
+        bool shuffle;
+        bool deflate;
+        int deflate_level;
+        bool has_fill;
+        /// @brief Fill mode as returned by nc_inq_var_fill, 0 if fill is on
+        int no_fill;
+        SchemaValue fill;
+        std::vector<AttributeSchema> attributes;
+    };
+
+    struct GroupSchema {
+        int id;
+        std::string name;
+        std::vector<DimensionSchema> dimensions;
+        std::map<int, std::shared_ptr<const VariableSchema>> variables;
+        std::vector<int> subgroups;
+        std::vector<AttributeSchema> attributes;
+    };
+
+    /// @brief Snapshot of whole file metadata. Never changed after it is published
+    struct FileSchema {
+        std::map<int, std::shared_ptr<const GroupSchema>> groups;
+        /// @brief Ids of unlimited dimensions, shapes using them change on writes
+        std::set<int> unlimited;
+    };
+
+    /**
+     * @brief Process-wide registry of file schemas
+     * Schema is loaded once when file is opened, so dimensions, shapes, types, chunking,
+     * fill values and attributes are available synchronously. Snapshots are immutable:
+     * operations which change metadata publish new snapshot sharing unchanged parts with old one.
+     * Load and Refresh* call libnetcdf and must be called with netcdf lock held.
+     */
+    class SchemaRegistry {
+        public:
+            /// @brief Registry instance
+            /// @return registry
+            static SchemaRegistry &Instance();
+            /// @brief Walk whole file hierarchy and publish its schema
+            /// @param id NetCDF file id
+            /// @return NetCDF status, schema is not published on failure
+            int Load(int id);
+            /// @brief Publish schema built elsewhere, e.g. read from metadata index
+            /// @param id NetCDF file id
+            /// @param schema Schema
+            void Adopt(int id, std::shared_ptr<const FileSchema> schema);
+            /// @brief Forget schema of closed file
+            /// @param id NetCDF file id
+            void Remove(int id);
+            /// @brief Current schema of file
+            /// @param ncid NetCDF file or group id
+            /// @return Schema or empty pointer if file has no schema loaded
+            std::shared_ptr<const FileSchema> Find(int ncid);
+            /// @brief Reload dimensions, attributes, name and subgroups of group
+            /// @param ncid NetCDF group id
+            void RefreshGroup(int ncid);
+            /// @brief Reload variable
+            /// @param ncid NetCDF group id
+            /// @param varid Variable id, NC_GLOBAL reloads group
+            void RefreshVariable(int ncid, int varid);
+            /// @brief Reload lengths of unlimited dimensions of variable after write
+            /// @param ncid NetCDF group id
+            /// @param varid Written variable id
+            void RefreshLengths(int ncid, int varid);
+        private:
+            SchemaRegistry() {};
+            void Publish(int ncid, std::shared_ptr<const FileSchema> schema);
+            std::mutex lock;
+            std::map<int, std::shared_ptr<const FileSchema>> files;
+    };
+
+    /// @brief Names of sections of described group
+    extern const char *describe_sections[5];
+    /// @brief Walk file hierarchy. Must be called with netcdf lock held
+    /// @param id NetCDF file id
+    /// @param file Schema
+    /// @param recursive Load subgroups, otherwise only root group is loaded
+    /// @return NetCDF status
+    int loadSchema(int id, FileSchema &file, bool recursive=true);
+    /// @brief Append string as JSON string literal
+    /// @param value String
+    /// @param json Output
+    void jsonString(const std::string &value, std::string &json);
+    /// @brief Serialize group with all its subgroups into compact JSON
+    /// @param file File schema
+    /// @param ncid NetCDF group id
+    /// @param json Output
+    void describeGroup(const FileSchema &file, int ncid, std::string &json);
+    /// @brief Serialize one section of group description, `null` for unknown section
+    /// @param file File schema
+    /// @param ncid NetCDF group id
+    /// @param section One of describe_sections
+    /// @param json Output
+    void describeSection(const FileSchema &file, int ncid, const std::string &section, std::string &json);
+    /// @brief Build JS value of schema value
+    /// @param env NodeJS environment
+    /// @param value Value
+    /// @return JS number, string, array or TypedArray as returned by async getters
+    Napi::Value schemaValue(Napi::Env env, const SchemaValue &value);
+    /// @brief JS dimension length, "unlimited" for unlimited dimension of zero length
+    /// @param env NodeJS environment
+    /// @param len Length
+    Napi::Value dimensionLength(Napi::Env env, size_t len);
+    /// @brief Group schema or exception if schema is not loaded
+    /// @param env NodeJS environment
+    /// @param ncid NetCDF group id
+    /// @param file File schema, kept to keep group alive
+    const GroupSchema &findGroupSchema(Napi::Env env, int ncid, std::shared_ptr<const FileSchema> &file);
+
+}
+
+#endif
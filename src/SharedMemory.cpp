@@ -0,0 +1,195 @@
+#include "SharedMemory.h"
+#include <atomic>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "netcdf4-async.h"
+
+namespace netcdf4async {
+
+/**
+ * @brief Mapped shared memory segment
+ * Lives as long as ArrayBuffer which wraps it
+ */
+struct SharedSegment {
+	/// @brief Mapped memory
+	void *data;
+	/// @brief Mapped size
+	size_t size;
+#ifdef _WIN32
+	/// @brief File mapping handle
+	HANDLE handle;
+#endif
+};
+
+/**
+ * @brief Map named segment into process memory
+ * 
+ * @param name segment name
+ * @param size segment size
+ * @param create create new segment, otherwise open existing one, which must be at least size bytes long
+ * @return SharedSegment* 
+ */
+static SharedSegment *map_segment(const std::string &name, size_t size, bool create) {
+	// Zero sized mappings are not allowed
+	size_t mapped = size > 0 ? size : 1;
+	SharedSegment *segment = new SharedSegment();
+	segment->size = size;
+#ifdef _WIN32
+	if (create) {
+		segment->handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+			static_cast<DWORD>(static_cast<uint64_t>(mapped) >> 32),
+			static_cast<DWORD>(mapped & 0xFFFFFFFF), name.c_str());
+	}
+	else {
+		segment->handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+	}
+	if (segment->handle == NULL) {
+		delete segment;
+		throw std::runtime_error(string_format("NetCDF4: Can't open shared memory %s", name.c_str()));
+	}
+	segment->data = MapViewOfFile(segment->handle, FILE_MAP_ALL_ACCESS, 0, 0, mapped);
+	if (segment->data == NULL) {
+		CloseHandle(segment->handle);
+		delete segment;
+		throw std::runtime_error(string_format("NetCDF4: Can't map shared memory %s", name.c_str()));
+	}
+#else
+	int fd = create ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)
+					: shm_open(name.c_str(), O_RDWR, 0600);
+	if (fd < 0) {
+		delete segment;
+		throw std::runtime_error(string_format("NetCDF4: Can't open shared memory %s", name.c_str()));
+	}
+	if (create && ftruncate(fd, static_cast<off_t>(mapped)) != 0) {
+		close(fd);
+		shm_unlink(name.c_str());
+		delete segment;
+		throw std::runtime_error(string_format("NetCDF4: Can't allocate shared memory %s", name.c_str()));
+	}
+	// Access beyond end of segment raises SIGBUS instead of error
+	struct stat st;
+	if (!create && (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < mapped)) {
+		close(fd);
+		delete segment;
+		throw std::runtime_error(string_format("NetCDF4: Shared memory %s is smaller than %llu bytes", name.c_str(),
+			static_cast<unsigned long long>(mapped)));
+	}
+	segment->data = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (segment->data == MAP_FAILED) {
+		if (create) {
+			shm_unlink(name.c_str());
+		}
+		delete segment;
+		throw std::runtime_error(string_format("NetCDF4: Can't map shared memory %s", name.c_str()));
+	}
+#endif
+	return segment;
+}
+
+/**
+ * @brief Remove segment name. Memory stays available for existing mappings
+ * 
+ * @param name segment name
+ */
+static void unlink_segment(const std::string &name) {
+#ifndef _WIN32
+	shm_unlink(name.c_str());
+#endif
+}
+
+/**
+ * @brief Wrap segment into ArrayBuffer, which unmaps segment when garbage collected
+ * 
+ * @param env NodeJS environment
+ * @param segment mapped segment
+ * @return Napi::ArrayBuffer 
+ */
+static Napi::ArrayBuffer wrap_segment(Napi::Env env, SharedSegment *segment) {
+	return Napi::ArrayBuffer::New(env, segment->data, segment->size,
+		[](Napi::Env env, void *data, SharedSegment *segment) {
+#ifdef _WIN32
+			UnmapViewOfFile(segment->data);
+			CloseHandle(segment->handle);
+#else
+			munmap(segment->data, segment->size > 0 ? segment->size : 1);
+#endif
+			delete segment;
+		},
+		segment);
+}
+
+Napi::Value create_shared(const Napi::CallbackInfo &info) {
+	static std::atomic<unsigned int> counter(0);
+	Napi::Env env = info.Env();
+	if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().Int64Value() < 0 ||
+		(info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString())) {
+		Napi::TypeError::New(env, "Expecting segment size and optional name").ThrowAsJavaScriptException();
+		return env.Undefined();
+	}
+	size_t size = static_cast<size_t>(info[0].As<Napi::Number>().Int64Value());
+	std::string name;
+	if (info.Length() > 1 && info[1].IsString()) {
+		name = info[1].As<Napi::String>().Utf8Value();
+	}
+	else {
+#ifdef _WIN32
+		name = string_format("Local\\nc4a.%lu.%u", GetCurrentProcessId(), counter++);
+#else
+		// macOS limits segment names to 31 characters
+		name = string_format("/nc4a.%ld.%u", static_cast<long>(getpid()), counter++);
+#endif
+	}
+	SharedSegment *segment;
+	try {
+		segment = map_segment(name, size, true);
+	} catch (const std::runtime_error &e) {
+		Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+		return env.Undefined();
+	}
+	Napi::Object result = Napi::Object::New(env);
+	result.Set("name", Napi::String::New(env, name));
+	result.Set("buffer", wrap_segment(env, segment));
+	return result;
+}
+
+Napi::Value attach_shared(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber() || info[1].As<Napi::Number>().Int64Value() < 0) {
+		Napi::TypeError::New(env, "Expecting segment name and size").ThrowAsJavaScriptException();
+		return env.Undefined();
+	}
+	std::string name = info[0].As<Napi::String>().Utf8Value();
+	size_t size = static_cast<size_t>(info[1].As<Napi::Number>().Int64Value());
+	bool unlink = info.Length() > 2 && info[2].ToBoolean().Value();
+	SharedSegment *segment;
+	try {
+		segment = map_segment(name, size, false);
+	} catch (const std::runtime_error &e) {
+		Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+		return env.Undefined();
+	}
+	if (unlink) {
+		unlink_segment(name);
+	}
+	return wrap_segment(env, segment);
+}
+
+Napi::Value unlink_shared(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	if (info.Length() < 1 || !info[0].IsString()) {
+		Napi::TypeError::New(env, "Expecting segment name").ThrowAsJavaScriptException();
+		return env.Undefined();
+	}
+	unlink_segment(info[0].As<Napi::String>().Utf8Value());
+	return env.Undefined();
+}
+
+}
@@ -0,0 +1,24 @@
+#ifndef NETCDF4_SHAREDMEMORY_H
+#define NETCDF4_SHAREDMEMORY_H
+
+#include <napi.h>
+#include <string>
+
+namespace netcdf4async {
+
+/// @brief Create named shared memory segment
+/// @param info NodeJS params: size in bytes, optional segment name chosen by caller
+/// @return Object with segment `name` and `buffer` (ArrayBuffer mapped to segment)
+Napi::Value create_shared(const Napi::CallbackInfo &info);
+/// @brief Map existing named shared memory segment, which must be at least size bytes long
+/// @param info NodeJS params: segment name, size in bytes, unlink segment name after mapping
+/// @return ArrayBuffer mapped to segment
+Napi::Value attach_shared(const Napi::CallbackInfo &info);
+/// @brief Remove name of segment which will never be attached, e.g. after failed read
+/// @param info NodeJS params: segment name
+/// @return undefined
+Napi::Value unlink_shared(const Napi::CallbackInfo &info);
+
+}
+
+#endif
@@ -6,6 +6,12 @@
 #include "async.h"
 #include "Attribute.h"
 #include "Macros.h"
+#include "Coalescer.h"
+#include "ResultCache.h"
+#include "Schema.h"
+#include "ChunkEngine.h"
+#include "Decimator.h"
+#include "AdaptiveCache.h"
 
 
 namespace netcdf4async {
@@ -16,14 +22,83 @@ struct DeflateInfo {
 	int level;
 };
 
+/// @brief Default limit of chunk cache in adaptive mode
+const size_t default_adaptive_cache_max = 256 * 1024 * 1024;
+
+/**
+ * @brief Smallest prime not less than n, HDF5 recommends prime number of hash slots
+ */
+static size_t next_prime(size_t n) {
+	for (;; n++) {
+		bool prime = n > 1;
+		for (size_t d = 2; d * d <= n && prime; d++) {
+			prime = n % d != 0;
+		}
+		if (prime) {
+			return n;
+		}
+	}
+}
+
+/**
+ * @brief Size chunk cache to keep all chunks touched by observed reads
+ * Cache holds at least one chunk and at most max_size bytes. Number of hash slots is
+ * about 100 per cached chunk. Does nothing for contiguous (and netCDF-3) variables.
+ * Must be called under netcdf lock
+ * @return int NetCDF status
+ */
+static int apply_adaptive_cache(int parent_id, int id, const std::vector<size_t> &observed, size_t max_size) {
+	int ndims, storage;
+	nc_type type;
+	int retval = nc_inq_var(parent_id, id, NULL, &type, &ndims, NULL, NULL);
+	if (retval != NC_NOERR) {
+		return retval;
+	}
+	std::vector<size_t> chunks(ndims);
+	if (nc_inq_var_chunking(parent_id, id, &storage, chunks.data()) != NC_NOERR || storage != NC_CHUNKED) {
+		return NC_NOERR;
+	}
+	std::vector<int> dimids(ndims);
+	size_t type_size;
+	if ((retval = nc_inq_vardimid(parent_id, id, dimids.data())) != NC_NOERR ||
+		(retval = nc_inq_type(parent_id, type, NULL, &type_size)) != NC_NOERR) {
+		return retval;
+	}
+	size_t chunk_bytes = type_size;
+	size_t touched = 1;
+	for (int i = 0; i < ndims; i++) {
+		size_t len;
+		if ((retval = nc_inq_dimlen(parent_id, dimids[i], &len)) != NC_NOERR) {
+			return retval;
+		}
+		chunk_bytes *= chunks[i];
+		size_t extent = i < static_cast<int>(observed.size()) ? observed[i] : 0;
+		// Unaligned extent may touch one more chunk
+		size_t span = extent > 1 ? (extent + chunks[i] - 2) / chunks[i] + 1 : 1;
+		size_t total = (len + chunks[i] - 1) / chunks[i];
+		touched *= std::max<size_t>(1, total > 0 ? std::min(span, total) : span);
+	}
+	size_t size = std::min(max_size, touched * chunk_bytes);
+	size = std::max(size, chunk_bytes);
+	size_t nelems = next_prime(std::max<size_t>(size / chunk_bytes * 100, 521));
+	return nc_set_var_chunk_cache(parent_id, id, size, nelems, 0.75f);
+}
+
+struct SlicesResult {
+	std::vector<Item> items;
+	std::vector<size_t> offsets;
+};
+
 Napi::FunctionReference Variable::constructor;
 
-Napi::Object Variable::Build(Napi::Env env, int id, int parent_id, std::string name, nc_type type, int ndims) {
-	return constructor.New({Napi::Number::New(env, id),
+Napi::Object Variable::Build(Napi::Env env, int id, int parent_id, std::string name, nc_type type, int ndims, const std::shared_ptr<bool> &token) {
+	Napi::Object variable = constructor.New({Napi::Number::New(env, id),
 		Napi::Number::New(env, parent_id),
 		Napi::String::New(env, name),
 		Napi::Number::New(env, type),
 		Napi::Number::New(env, ndims)});
+	Variable::Unwrap(variable)->token = token;
+	return variable;
 }
 
 Variable::Variable(const Napi::CallbackInfo &info) : Napi::ObjectWrap<Variable>(info) {
@@ -46,6 +121,9 @@ void Variable::Init(Napi::Env env) {
                 InstanceMethod("read", &Variable::Read),
 		        InstanceMethod("readSlice", &Variable::ReadSlice),
 		        InstanceMethod("readStridedSlice", &Variable::ReadStridedSlice),
+		        InstanceMethod("readSliceInto", &Variable::ReadSliceInto),
+		        InstanceMethod("readStridedSliceInto", &Variable::ReadStridedSliceInto),
+		        InstanceMethod("readSlices", &Variable::ReadSlices),
 		        InstanceMethod("write", &Variable::Write),
 		        InstanceMethod("writeSlice", &Variable::WriteSlice),
 		        InstanceMethod("writeStridedSlice", &Variable::WriteStridedSlice),
@@ -61,6 +139,8 @@ void Variable::Init(Napi::Env env) {
                 InstanceMethod("getFillMode", &Variable::GetFillMode),
                 InstanceMethod("getChunked", &Variable::GetChunked),
                 InstanceMethod("setChunked", &Variable::SetChunked),
+                InstanceMethod("getChunkCache", &Variable::GetChunkCache),
+                InstanceMethod("setChunkCache", &Variable::SetChunkCache),
                 InstanceMethod("getDeflateInfo", &Variable::GetDeflateInfo),
                 InstanceMethod("setDeflateInfo", &Variable::SetDeflateInfo),
                 InstanceMethod("getEndianness", &Variable::GetEndianness),
@@ -75,6 +155,11 @@ void Variable::Init(Napi::Env env) {
 
 		        InstanceAccessor<&Variable::GetTypeSync>("type"),
 		        InstanceAccessor<&Variable::GetNameSync>("name"),
+		        InstanceAccessor<&Variable::GetShapeSync>("shape"),
+		        InstanceAccessor<&Variable::GetDimensionsSync>("dimensions"),
+		        InstanceAccessor<&Variable::GetChunkedSync>("chunked"),
+		        InstanceAccessor<&Variable::GetFillSync>("fill"),
+		        InstanceAccessor<&Variable::GetAttributesSync>("attributes"),
 		        
 			}
 		);
@@ -89,6 +174,80 @@ Napi::Value Variable::GetTypeSync(const Napi::CallbackInfo &info) {
 
 }
 
+/**
+ * @brief Schema of variable loaded at open
+ * @param env NodeJS environment
+ * @param parent_id Group id
+ * @param id Variable id
+ * @param file File schema, kept to keep variable alive
+ * @return const VariableSchema&
+ */
+static const VariableSchema &find_variable_schema(Napi::Env env, int parent_id, int id, std::shared_ptr<const FileSchema> &file) {
+	const GroupSchema &group = findGroupSchema(env, parent_id, file);
+	auto it = group.variables.find(id);
+	if (it == group.variables.end()) {
+		throw Napi::Error::New(env, "NetCDF4: Variable not found in schema");
+	}
+	return *it->second;
+}
+
+Napi::Value Variable::GetShapeSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const VariableSchema &variable = find_variable_schema(env, this->parent_id, this->id, file);
+	Napi::Array shape = Napi::Array::New(env, variable.shape.size());
+	for (size_t i = 0; i < variable.shape.size(); i++) {
+		shape.Set(i, Napi::Number::New(env, static_cast<double>(variable.shape[i])));
+	}
+	return shape;
+}
+
+Napi::Value Variable::GetDimensionsSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const VariableSchema &variable = find_variable_schema(env, this->parent_id, this->id, file);
+	Napi::Object dimensions = Napi::Object::New(env);
+	for (size_t i = 0; i < variable.dim_names.size(); i++) {
+		dimensions.Set(variable.dim_names[i], dimensionLength(env, variable.shape[i]));
+	}
+	return dimensions;
+}
+
+Napi::Value Variable::GetChunkedSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const VariableSchema &variable = find_variable_schema(env, this->parent_id, this->id, file);
+	Napi::Object obj = Napi::Object::New(env);
+	obj.Set("mode", variable.storage == NC_CHUNKED ? "chunked" : variable.storage == NC_CONTIGUOUS ? "contiguous" : "unknown");
+	Napi::Int32Array sizes = Napi::Int32Array::New(env, variable.chunks.size());
+	for (size_t i = 0; i < variable.chunks.size(); i++) {
+		sizes[i] = static_cast<int32_t>(variable.chunks[i]);
+	}
+	obj.Set("sizes", variable.chunks.size() == 1 ? Napi::Number::New(env, sizes[0]) : sizes.As<Napi::Value>());
+	return obj;
+}
+
+Napi::Value Variable::GetFillSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const VariableSchema &variable = find_variable_schema(env, this->parent_id, this->id, file);
+	Napi::Object obj = Napi::Object::New(env);
+	obj.Set("value", variable.has_fill ? schemaValue(env, variable.fill) : env.Undefined());
+	obj.Set("mode", Napi::Boolean::New(env, variable.no_fill == 0));
+	return obj;
+}
+
+Napi::Value Variable::GetAttributesSync(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	std::shared_ptr<const FileSchema> file;
+	const VariableSchema &variable = find_variable_schema(env, this->parent_id, this->id, file);
+	Napi::Object attributes = Napi::Object::New(env);
+	for (auto &attribute : variable.attributes) {
+		attributes.Set(attribute.name, schemaValue(env, attribute.value));
+	}
+	return attributes;
+}
+
 Napi::Value Variable::GetName(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 	Variable *variable = this;
@@ -104,7 +263,7 @@ Napi::Value Variable::GetName(const Napi::CallbackInfo &info) {
 			return Napi::String::New(env, result);
 		}
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
     return worker->Deferred().Promise();	
 }
 
@@ -125,6 +284,7 @@ Napi::Value  Variable::SetName(const Napi::CallbackInfo &info) {
 		env, deferred,
 		[id = this->id, parent_id = this->parent_id, new_name] (const NCAsyncWorker<std::string>* worker) {
 			NC_CALL(nc_rename_var(parent_id, id,  new_name.c_str()));
+			SchemaRegistry::Instance().RefreshVariable(parent_id, id);
 			return std::string(new_name);
 		},
 		[variable] (Napi::Env env, std::string result) {
@@ -132,7 +292,7 @@ Napi::Value  Variable::SetName(const Napi::CallbackInfo &info) {
 			return Napi::String::New(env, result);
 		}
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
     return worker->Deferred().Promise();
 }
 
@@ -177,7 +337,7 @@ Napi::Value Variable::GetDimensions(const Napi::CallbackInfo &info) {
          	return dimensions;
 		}
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
     return worker->Deferred().Promise();
 }
 
@@ -253,7 +413,7 @@ Napi::Value Variable::_getFillInfo(Napi::Env env,bool return_mode) { //const Nap
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
     return worker->Deferred().Promise();
 }
 
@@ -356,12 +516,18 @@ Napi::Value  Variable::SetFill(const Napi::CallbackInfo &info) {
 
     auto worker=new NCAsyncWorker<int>(
 		env, deferred,
-		[id, parent_id, item=nc_item] (const NCAsyncWorker<int>* worker) {
+		[id, parent_id, type=this->type, item=nc_item] (const NCAsyncWorker<int>* worker) {
             int mode=item.fill_mode;
+            int status=NC_NOERR;
             if (mode==-1) {
-	            NC_CALL(nc_inq_var_fill(parent_id, id, &mode, NULL));
+	            status=nc_inq_var_fill(parent_id, id, &mode, NULL);
+            }
+            if (status==NC_NOERR) {
+	            status=nc_def_var_fill(parent_id, id, mode, item.value.v);
             }
-	        NC_CALL(nc_def_var_fill(parent_id, id, mode, item.value.v));
+            releaseValue(type, item.value.v);
+	        NC_CALL(status);
+	        SchemaRegistry::Instance().RefreshVariable(parent_id, id);
 	        
 		    return 1;
 		},
@@ -370,7 +536,8 @@ Napi::Value  Variable::SetFill(const Napi::CallbackInfo &info) {
 		}
 		
 	);
-	worker->Queue();
+	ResultCache::Instance().Invalidate(this->parent_id);
+	worker->Queue(this->parent_id, token);
     
     return deferred.Promise();
 }
@@ -383,8 +550,12 @@ Napi::Value Variable::GetChunked(const Napi::CallbackInfo &info) {
 		[parent_id = this->parent_id, id = this-> id, ndims = this->ndims] (const NCAsyncWorker<Item>* worker) {
             int v;
 			Item item;
-			item.value.size =  new size_t[ndims];
-			NC_CALL(nc_inq_var_chunking(parent_id, id, &v, item.value.size));
+			std::vector<size_t> sizes(ndims);
+			NC_CALL(nc_inq_var_chunking(parent_id, id, &v, sizes.data()));
+			TYPED_VALUE(item.value,int32_t,ndims)
+			for (int i = 0; i < ndims; i++) {
+				item.value.i32[i] = static_cast<int32_t>(sizes[i]);
+			}
 	
 			switch (v) {
 			case NC_CONTIGUOUS:
@@ -412,7 +583,7 @@ Napi::Value Variable::GetChunked(const Napi::CallbackInfo &info) {
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
     
     return worker->Deferred().Promise();
 }
@@ -452,6 +623,7 @@ Napi::Value  Variable::SetChunked(const Napi::CallbackInfo &info) {
 		env, deferred, 
 		[parent_id = this->parent_id, id = this-> id, ndims = this->ndims, v, sizes] (const NCAsyncWorker<int>* worker) {
 			NC_CALL(nc_def_var_chunking(parent_id, id, v, sizes));
+			SchemaRegistry::Instance().RefreshVariable(parent_id, id);
 			delete[] sizes;
             return 1;
 		},
@@ -460,11 +632,118 @@ Napi::Value  Variable::SetChunked(const Napi::CallbackInfo &info) {
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
 
     return deferred.Promise();
 }
 
+/**
+ * @brief Get HDF5 chunk cache settings of variable
+ * @param info NodeJS params
+ * @return Napi::Value Deferred promise resolved to `{size, nelems, preemption, adaptive}`
+ */
+Napi::Value Variable::GetChunkCache(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	auto worker=new NCAsyncWorker<ChunkCache>(
+		env,
+		[parent_id = this->parent_id, id = this->id] (const NCAsyncWorker<ChunkCache>* worker) {
+			ChunkCache cache;
+			NC_CALL(nc_get_var_chunk_cache(parent_id, id, &cache.size, &cache.nelems, &cache.preemption));
+			return cache;
+		},
+		[adaptive = AdaptiveCacheRegistry::Instance().Enabled(this->parent_id, this->id)] (Napi::Env env, ChunkCache result) {
+			Napi::Object obj = Napi::Object::New(env);
+			obj.Set("size", Napi::Number::New(env, static_cast<double>(result.size)));
+			obj.Set("nelems", Napi::Number::New(env, static_cast<double>(result.nelems)));
+			obj.Set("preemption", Napi::Number::New(env, result.preemption));
+			obj.Set("adaptive", Napi::Boolean::New(env, adaptive));
+			return obj;
+		}
+	);
+	worker->Queue(this->parent_id, token);
+	return worker->Deferred().Promise();
+}
+
+/**
+ * @brief Set HDF5 chunk cache settings of variable
+ * Accepts `{size, nelems, preemption}` (missing fields keep current values) or
+ * `{adaptive: true[, maxSize]}` to size cache by chunk shape and observed reads
+ * @param info NodeJS params
+ * @return Napi::Value Deferred promise
+ */
+Napi::Value Variable::SetChunkCache(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+	ChunkCache cache;
+	std::string error;
+	if (info.Length() < 1 || !parseChunkCache(info[0], cache, error)) {
+		deferred.Reject(Napi::String::New(env, info.Length() < 1 ? "Wrong number of arguments" : error));
+		return deferred.Promise();
+	}
+	Napi::Object settings = info[0].As<Napi::Object>();
+	bool adaptive = settings.Get("adaptive").ToBoolean().Value();
+	AdaptiveCache state;
+	if (adaptive) {
+		Napi::Value max_size = settings.Get("maxSize");
+		if (!max_size.IsUndefined() && (!max_size.IsNumber() || max_size.As<Napi::Number>().Int64Value() < 1)) {
+			deferred.Reject(Napi::String::New(env, "maxSize must be a positive integer"));
+			return deferred.Promise();
+		}
+		state = AdaptiveCacheRegistry::Instance().Enable(this->parent_id, this->id, this->ndims, max_size.IsUndefined() ?
+			default_adaptive_cache_max : static_cast<size_t>(max_size.As<Napi::Number>().Int64Value()));
+	}
+	else {
+		AdaptiveCacheRegistry::Instance().Disable(this->parent_id, this->id);
+	}
+	auto worker=new NCAsyncWorker<int>(
+		env, deferred,
+		[parent_id = this->parent_id, id = this->id, cache, adaptive, state] (const NCAsyncWorker<int>* worker) {
+			if (adaptive) {
+				NC_CALL(apply_adaptive_cache(parent_id, id, state.observed, state.max_size));
+				return 1;
+			}
+			ChunkCache current;
+			NC_CALL(nc_get_var_chunk_cache(parent_id, id, &current.size, &current.nelems, &current.preemption));
+			NC_CALL(nc_set_var_chunk_cache(parent_id, id,
+				cache.has_size ? cache.size : current.size,
+				cache.has_nelems ? cache.nelems : current.nelems,
+				cache.has_preemption ? cache.preemption : current.preemption
+			));
+			return 1;
+		},
+		[] (Napi::Env env, int result) {
+			return env.Undefined();
+		}
+	);
+	worker->Queue(this->parent_id, token);
+	return deferred.Promise();
+}
+
+/**
+ * @brief Grow chunk cache in adaptive mode if read hyperslab is larger than observed before
+ * Resizing is queued before the read, so the read already uses new cache
+ * @param slab Read hyperslab
+ */
+void Variable::adaptChunkCache(const Hyperslab &slab) {
+	AdaptiveCache state;
+	if (!AdaptiveCacheRegistry::Instance().Observe(this->parent_id, this->id, slab, state)) {
+		return;
+	}
+	Napi::Env env = this->Env();
+	auto worker=new NCAsyncWorker<int>(
+		env,
+		[parent_id = this->parent_id, id = this->id, state] (const NCAsyncWorker<int>* worker) {
+			// Tuning is best effort, failure must not reject anything
+			apply_adaptive_cache(parent_id, id, state.observed, state.max_size);
+			return 1;
+		},
+		[] (Napi::Env env, int result) {
+			return env.Undefined();
+		}
+	);
+	worker->Queue(this->parent_id, token);
+}
+
 Napi::Value Variable::GetDeflateInfo(const Napi::CallbackInfo &info) {
 	Napi::Env env = info.Env();
 	auto worker = new NCAsyncWorker<DeflateInfo>(
@@ -488,7 +767,7 @@ Napi::Value Variable::GetDeflateInfo(const Napi::CallbackInfo &info) {
 			return obj;
 		}
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
     return worker->Deferred().Promise();
 }
 
@@ -521,7 +800,7 @@ Napi::Value  Variable::SetDeflateInfo(const Napi::CallbackInfo &info) {
 			return obj;
 		}
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
     return worker->Deferred().Promise();
 }
 
@@ -554,7 +833,7 @@ Napi::Value Variable::GetEndianness(const Napi::CallbackInfo &info) {
 		}
 		
 	);
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
 	
     return worker->Deferred().Promise();
 }
@@ -588,7 +867,7 @@ Napi::Value Variable::SetEndianness(const Napi::CallbackInfo &info) {
 		[] (Napi::Env env, int result) {
 			return Napi::Number::New(env, result);
 		});
-	worker->Queue();
+	worker->Queue(this->parent_id, token);
     return worker->Deferred().Promise();
 }
 
@@ -617,7 +896,7 @@ Napi::Value Variable::GetChecksumMode(const Napi::CallbackInfo &info) {
 			}
 			return Napi::String::New(env, res);
 		});
-	worker->Queue();	
+	worker->Queue(this->parent_id, token);	
     return worker->Deferred().Promise();
 }
 
@@ -648,7 +927,7 @@ Napi::Value  Variable::SetChecksumMode(const Napi::CallbackInfo &info) {
 		[] (Napi::Env env, int result) {
 			return Napi::Number::New(env, result);
 		});
-	worker->Queue();	
+	worker->Queue(this->parent_id, token);	
     return worker->Deferred().Promise();
 }
 
@@ -661,7 +940,7 @@ Napi::Value Variable::GetAttributes(const Napi::CallbackInfo &info) {
 	Napi::Env env = info.Env();
 	int id = this->id;
 	int parent_id = this->parent_id;
- 	return netcdf4async::get_attributes(env, parent_id, id, return_type);
+ 	return netcdf4async::get_attributes(env, parent_id, id, return_type, token);
 }
 
 Napi::Value Variable::AddAttribute(const Napi::CallbackInfo &info) {
@@ -676,7 +955,7 @@ Napi::Value Variable::AddAttribute(const Napi::CallbackInfo &info) {
 	Napi::Env env = info.Env();
 	int id = this->id;
 	int parent_id = this->parent_id;
-	return add_attribute(env, deferred, parent_id, id, name, type, info[2]);
+	return add_attribute(env, deferred, parent_id, id, name, type, info[2], token);
 }
 
 
@@ -695,7 +974,7 @@ Napi::Value Variable::RenameAttribute(const Napi::CallbackInfo &info) {
 	}
 	std::string old_attribute_name = info[0].As<Napi::String>().Utf8Value();
 	std::string new_attribute_name = info[0].As<Napi::String>().Utf8Value();
-    return rename_attribute(env, deferred, this->parent_id, this->id, old_attribute_name, new_attribute_name);
+    return rename_attribute(env, deferred, this->parent_id, this->id, old_attribute_name, new_attribute_name, token);
 }
 
 Napi::Value Variable::DeleteAttribute(const Napi::CallbackInfo &info) {
@@ -706,7 +985,7 @@ Napi::Value Variable::DeleteAttribute(const Napi::CallbackInfo &info) {
 		return deferred.Promise();
 	}
 	std::string attribute_name = info[0].As<Napi::String>().Utf8Value();
-    return delete_attribute(env, deferred, this->parent_id, this->id, attribute_name);
+    return delete_attribute(env, deferred, this->parent_id, this->id, attribute_name, token);
 }
 
 Napi::Value Variable::Write(const Napi::CallbackInfo &info) {
@@ -793,14 +1072,20 @@ Napi::Value Variable::Write(const Napi::CallbackInfo &info) {
     auto worker=new NCAsyncWorker<int>(
 		env, deferred, 
 		[id=this->id, parent_id=this->parent_id, type = this->type, pos, size, nc_item](const NCAsyncWorker<int>* worker) {
-			NC_CALL(nc_put_vara(parent_id, id, pos, size, nc_item.value.v));
+			int status = nc_put_vara(parent_id, id, pos, size, nc_item.value.v);
+			releaseValue(type, nc_item.value.v);
+			delete[] pos;
+			delete[] size;
+			NC_CALL(status);
+			SchemaRegistry::Instance().RefreshLengths(parent_id, id);
 			return 1;
 		},
 		[] (Napi::Env env, int result) {
 			return Napi::String::New(env,"OK");
 		}
 	);
-	worker->Queue();	
+	ResultCache::Instance().Invalidate(this->parent_id);
+	worker->Queue(this->parent_id, token);	
 	
     return worker->Deferred().Promise();
 }
@@ -896,19 +1181,34 @@ Napi::Value Variable::WriteSlice(const Napi::CallbackInfo &info) {
         deferred.Reject(Napi::String::New(info.Env(),"Variable type not supported yet"));
 		return deferred.Promise();
 	}
+	// Deflated chunks of large writes may be compressed in parallel
+	if (this->type != NC_CHAR && this->type != NC_STRING && ChunkThreads::Instance().Size() > 0 && nc_item.len >= total_size) {
+		Hyperslab slab;
+		slab.start.assign(pos, pos + this->ndims);
+		slab.count.assign(size, size + this->ndims);
+		slab.len = total_size;
+		delete[] pos;
+		delete[] size;
+		ResultCache::Instance().Invalidate(this->parent_id);
+		return chunk_write(env, deferred, this->parent_id, this->id, this->type, slab, nc_item.value.v, token);
+	}
 	auto worker=new NCAsyncWorker<int>(
 		env, deferred, 
 		[id=this->id, parent_id=this->parent_id, type = this->type, pos, size, nc_item](const NCAsyncWorker<int>* worker) {
-			NC_CALL(nc_put_vara(parent_id, id, pos, size, nc_item.value.v));
+			int status = nc_put_vara(parent_id, id, pos, size, nc_item.value.v);
+			releaseValue(type, nc_item.value.v);
 			delete[] pos;
 			delete[] size;
+			NC_CALL(status);
+			SchemaRegistry::Instance().RefreshLengths(parent_id, id);
 			return 1;
 		},
 		[] (Napi::Env env, int result) {
 			return Napi::String::New(env,"OK");
 		}
 	);
-	worker->Queue();	
+	ResultCache::Instance().Invalidate(this->parent_id);
+	worker->Queue(this->parent_id, token);	
 	
     return worker->Deferred().Promise();
 }
@@ -1009,17 +1309,21 @@ Napi::Value Variable::WriteStridedSlice(const Napi::CallbackInfo &info) {
    auto worker=new NCAsyncWorker<int>(
 		env, deferred, 
 		[id=this->id, parent_id=this->parent_id, type = this->type, pos, size, stride, nc_item](const NCAsyncWorker<int>* worker) {
-			NC_CALL(nc_put_vars(parent_id, id, pos, size, stride, nc_item.value.v));
+			int status = nc_put_vars(parent_id, id, pos, size, stride, nc_item.value.v);
+			releaseValue(type, nc_item.value.v);
 			delete[] pos;
 			delete[] size;
 			delete[] stride;
+			NC_CALL(status);
+			SchemaRegistry::Instance().RefreshLengths(parent_id, id);
 			return 1;
 		},
 		[] (Napi::Env env, int result) {
 			return Napi::String::New(env,"OK");
 		}
 	);
-	worker->Queue();	
+	ResultCache::Instance().Invalidate(this->parent_id);
+	worker->Queue(this->parent_id, token);	
 	
     return worker->Deferred().Promise();
 }
@@ -1033,31 +1337,14 @@ Napi::Value Variable::Read(const Napi::CallbackInfo &info) {
     	return deferred.Promise();
 	}
 	
-	size_t *pos = new size_t[this->ndims];
-	size_t *size = new size_t[this->ndims];
+	Hyperslab slab;
+	slab.len = 1;
 	for (int i = 0; i < this->ndims; i++) {
-		pos[i] = info[i].As<Napi::Number>().Int64Value();
-		size[i] = 1;
+		slab.start.push_back(info[i].As<Napi::Number>().Int64Value());
+		slab.count.push_back(1);
 	}
-    auto worker=new NCAsyncWorker<Item>(
-		env, deferred, 
-		[id=this->id, parent_id=this->parent_id, type = this->type, pos, size](const NCAsyncWorker<Item>* worker) {
-			Item result;
-			result.type = type;
-			result.len = 1;
-			typedValue(&result);
-            NC_CALL(nc_get_vara(parent_id, id, pos, size, result.value.v));
-			delete[] pos;
-			delete[] size;
-			return result;
-		},
-		[] (Napi::Env env, Item result) {
-			
-			return item2value(env, &result);
-		});
-	worker->Queue();	
-	
-    return worker->Deferred().Promise();
+	adaptChunkCache(slab);
+	return HyperslabReadWorker::Read(env, deferred, this->parent_id, this->id, this->type, slab, token);
 }
 
 Napi::Value Variable::ReadSlice(const Napi::CallbackInfo &info) {
@@ -1076,34 +1363,16 @@ Napi::Value Variable::ReadSlice(const Napi::CallbackInfo &info) {
 		deferred.Reject(Napi::String::New(info.Env(), "Variable type not supported yet"));
 		return deferred.Promise();
 	}
-	size_t *pos = new size_t[this->ndims];
-	size_t *size = new size_t[this->ndims];
-	size_t total_size = 1;
-
+	Hyperslab slab;
+	slab.len = 1;
 	for (int i = 0; i < this->ndims; i++) {
-		pos[i] = info[2 * i].As<Napi::Number>().Int64Value();
-		size[i] = info[2 * i + 1].As<Napi::Number>().Int64Value();
-		total_size *= size[i];
+		slab.start.push_back(info[2 * i].As<Napi::Number>().Int64Value());
+		slab.count.push_back(info[2 * i + 1].As<Napi::Number>().Int64Value());
+		slab.len *= slab.count[i];
 	}
 
-    auto worker=new NCAsyncWorker<Item>(
-		env, deferred,
-		[id=this->id, parent_id=this->parent_id, type = this->type, pos, size, total_size](const NCAsyncWorker<Item>* worker) {
-            Item result;
-			result.type = type;
-			result.len = total_size;
-			typedValue(&result);
-			NC_CALL(nc_get_vara(parent_id, id, pos, size,result.value.v));
-			delete[] pos;
-			delete[] size;
-			return result;
-		},
-		[] (Napi::Env env, Item result) {
-
-			return item2value(env, &result);
-		});
-	worker->Queue();	
-    return worker->Deferred().Promise();
+	adaptChunkCache(slab);
+	return HyperslabReadWorker::Read(env, deferred, this->parent_id, this->id, this->type, slab, token);
 }
 
 Napi::Value Variable::ReadStridedSlice(const Napi::CallbackInfo &info) {
@@ -1123,38 +1392,208 @@ Napi::Value Variable::ReadStridedSlice(const Napi::CallbackInfo &info) {
 		return deferred.Promise();
 	}
 
+	Hyperslab slab;
+	slab.len = 1;
+	for (int i = 0; i < this->ndims; i++) {
+		slab.start.push_back(info[3 * i].As<Napi::Number>().Int64Value());
+		slab.count.push_back(info[3 * i + 1].As<Napi::Number>().Int64Value());
+		slab.stride.push_back(static_cast<ptrdiff_t>(
+			info[3 * i + 2].As<Napi::Number>().Int64Value()
+		));
+		slab.len *= slab.count[i];
+	}
+
+	adaptChunkCache(slab);
+	return HyperslabReadWorker::Read(env, deferred, this->parent_id, this->id, this->type, slab, token);
+}
+
+Napi::Value Variable::ReadSliceInto(const Napi::CallbackInfo &info) {
+	return _readInto(info, false);
+}
+
+Napi::Value Variable::ReadStridedSliceInto(const Napi::CallbackInfo &info) {
+	return _readInto(info, true);
+}
+
+/**
+ * @brief Read hyperslab directly into caller-owned TypedArray
+ * Parameters are target TypedArray, element offset in target and then
+ * position/size (and stride if strided) for each dimension.
+ * Target is kept alive by reference while worker is in progress.
+ * @param info NodeJS params
+ * @param strided Read strided hyperslab
+ * @return Napi::Value Deferred promise resolved to target
+ */
+Napi::Value Variable::_readInto(const Napi::CallbackInfo &info, bool strided) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+	const int step = strided ? 3 : 2;
+	if (info.Length() != static_cast<size_t>(step * this->ndims + 2)) {
+		deferred.Reject(Napi::String::New(env, "Wrong number of arguments"));
+		return deferred.Promise();
+	}
+	if (!info[0].IsTypedArray()) {
+		deferred.Reject(Napi::String::New(env, "Expecting a typed array"));
+		return deferred.Promise();
+	}
+	Napi::TypedArray target = info[0].As<Napi::TypedArray>();
+	if (!typedArrayMatches(this->type, target.TypedArrayType())) {
+		deferred.Reject(Napi::String::New(env, "Typed array does not match variable type"));
+		return deferred.Promise();
+	}
+	int64_t offset = info[1].As<Napi::Number>().Int64Value();
+	if (offset < 0) {
+		deferred.Reject(Napi::String::New(env, "Offset must be non-negative"));
+		return deferred.Promise();
+	}
+
 	size_t *pos = new size_t[this->ndims];
 	size_t *size = new size_t[this->ndims];
-	ptrdiff_t *stride = new ptrdiff_t[this->ndims];
+	ptrdiff_t *stride = strided ? new ptrdiff_t[this->ndims] : NULL;
 	size_t total_size = 1;
-
 	for (int i = 0; i < this->ndims; i++) {
-		pos[i] = info[3 * i].As<Napi::Number>().Int64Value();
-		size[i] = info[3 * i + 1].As<Napi::Number>().Int64Value();
+		pos[i] = info[2 + step * i].As<Napi::Number>().Int64Value();
+		size[i] = info[2 + step * i + 1].As<Napi::Number>().Int64Value();
 		total_size *= size[i];
-		stride[i] = static_cast<ptrdiff_t>(
-			info[3 * i + 2].As<Napi::Number>().Int64Value()
-		);
+		if (strided) {
+			stride[i] = static_cast<ptrdiff_t>(info[2 + step * i + 2].As<Napi::Number>().Int64Value());
+		}
+	}
+	if (static_cast<size_t>(offset) + total_size > target.ElementLength()) {
+		delete[] pos;
+		delete[] size;
+		delete[] stride;
+		deferred.Reject(Napi::String::New(env, "Typed array is too small for requested slice"));
+		return deferred.Promise();
 	}
+	void *data = static_cast<uint8_t *>(target.ArrayBuffer().Data()) + target.ByteOffset() +
+		static_cast<size_t>(offset) * target.ElementSize();
+	auto keep = std::make_shared<Napi::Reference<Napi::TypedArray>>(Napi::Reference<Napi::TypedArray>::New(target, 1));
 
-    auto worker=new NCAsyncWorker<Item>(
+	auto worker=new NCAsyncWorker<int>(
 		env, deferred,
-		[id=this->id, parent_id=this->parent_id, type = this->type, pos, size, stride, total_size](const NCAsyncWorker<Item>* worker) {
-            Item result;
-			result.type = type;
-			result.len = total_size;
-			typedValue(&result);
-			NC_CALL(nc_get_vars(parent_id, id, pos, size, stride, result.value.v));
+		[id=this->id, parent_id=this->parent_id, ndims=this->ndims, pos, size, stride, total_size, data](const NCAsyncWorker<int>* worker) {
+			int retval;
+			if (stride != NULL) {
+				Hyperslab slab;
+				slab.start.assign(pos, pos + ndims);
+				slab.count.assign(size, size + ndims);
+				slab.stride.assign(stride, stride + ndims);
+				slab.len = total_size;
+				retval = read_strided(parent_id, id, slab, data);
+			}
+			else {
+				retval = nc_get_vara(parent_id, id, pos, size, data);
+			}
 			delete[] pos;
 			delete[] size;
 			delete[] stride;
+			NC_CALL(retval);
+			return 1;
+		},
+		[keep] (Napi::Env env, int result) {
+			return keep->Value();
+		});
+	worker->Queue(this->parent_id, token);
+	return worker->Deferred().Promise();
+}
+
+/**
+ * @brief Read many hyperslabs in one worker
+ * Parameters are array of `{start, count[, stride]}` descriptors and optional
+ * options object. With `packed` option all hyperslabs are read into one buffer.
+ * @param info NodeJS params
+ * @return Napi::Value Deferred promise resolved to array of values, or to
+ * `{data, offsets}` if packed
+ */
+Napi::Value Variable::ReadSlices(const Napi::CallbackInfo &info) {
+	Napi::Env env = info.Env();
+	Napi::Promise::Deferred deferred=Napi::Promise::Deferred::New(env);
+	if (info.Length() < 1 || !info[0].IsArray()) {
+		deferred.Reject(Napi::String::New(env, "Expecting an array of hyperslabs"));
+		return deferred.Promise();
+	}
+#if NODE_MAJOR_VERSION >= 10
+	if (this->type < NC_BYTE || (this->type > NC_UINT64 && this->type != NC_STRING)) {
+#else
+	if (this->type < NC_BYTE || (this->type > NC_UINT && this->type != NC_STRING)) {
+#endif
+		deferred.Reject(Napi::String::New(env, "Variable type not supported yet"));
+		return deferred.Promise();
+	}
+	bool packed = false;
+	if (info.Length() > 1 && info[1].IsObject()) {
+		packed = info[1].As<Napi::Object>().Get("packed").ToBoolean().Value();
+	}
+	Napi::Array descriptors = info[0].As<Napi::Array>();
+	std::vector<Hyperslab> slabs(descriptors.Length());
+	for (uint32_t i = 0; i < descriptors.Length(); i++) {
+		if (!parseHyperslab(descriptors.Get(i), this->ndims, slabs[i])) {
+			deferred.Reject(Napi::String::New(env, string_format("Wrong hyperslab at index %u", i)));
+			return deferred.Promise();
+		}
+	}
+
+	auto worker=new NCAsyncWorker<SlicesResult>(
+		env, deferred,
+		[id=this->id, parent_id=this->parent_id, type=this->type, slabs=std::move(slabs), packed](const NCAsyncWorker<SlicesResult>* worker) {
+			SlicesResult result;
+			try {
+				if (packed) {
+					Item item;
+					item.type = type;
+					item.len = 0;
+					for (auto &slab : slabs) {
+						result.offsets.push_back(item.len);
+						item.len += slab.len;
+					}
+					size_t type_size;
+					NC_CALL(nc_inq_type(parent_id, type, NULL, &type_size));
+					typedValue(&item);
+					result.items.push_back(item);
+					for (size_t i = 0; i < slabs.size(); i++) {
+						NC_CALL(readHyperslab(parent_id, id, slabs[i],
+							static_cast<uint8_t *>(item.value.v) + result.offsets[i] * type_size));
+					}
+				}
+				else {
+					for (auto &slab : slabs) {
+						Item item;
+						item.type = type;
+						item.len = slab.len;
+						typedValue(&item);
+						result.items.push_back(item);
+						NC_CALL(readHyperslab(parent_id, id, slab, item.value.v));
+					}
+				}
+			} catch (...) {
+				// Values read before failed hyperslab are never handed to JS
+				for (auto &item : result.items) {
+					releaseItem(&item);
+				}
+				throw;
+			}
 			return result;
 		},
-		[] (Napi::Env env, Item result) {
-			return item2value(env, &result);
+		[packed] (Napi::Env env, SlicesResult result) {
+			if (packed) {
+				Napi::Array offsets = Napi::Array::New(env, result.offsets.size());
+				for (size_t i = 0; i < result.offsets.size(); i++) {
+					offsets.Set(static_cast<uint32_t>(i), Napi::Number::New(env, static_cast<double>(result.offsets[i])));
+				}
+				Napi::Object obj = Napi::Object::New(env);
+				obj.Set("data", item2value(env, &result.items[0]));
+				obj.Set("offsets", offsets);
+				return obj.As<Napi::Value>();
+			}
+			Napi::Array values = Napi::Array::New(env, result.items.size());
+			for (size_t i = 0; i < result.items.size(); i++) {
+				values.Set(static_cast<uint32_t>(i), item2value(env, &result.items[i]));
+			}
+			return values.As<Napi::Value>();
 		});
-	worker->Queue();	
-    return worker->Deferred().Promise();
+	worker->Queue(this->parent_id, token);
+	return worker->Deferred().Promise();
 }
 
 void Variable::set_name(std::string new_name) {
@@ -1,5 +1,6 @@
 #include "async.h"
 #include <napi.h>
+#include <thread>
 
 namespace netcdf4async {
 /**
@@ -11,7 +12,7 @@ namespace netcdf4async {
     AsyncPromiseWorker::AsyncPromiseWorker(
         Napi::Env &env,
         Napi::Promise::Deferred deferred
-        ) : Napi::AsyncWorker(env), deferred(deferred) {
+        ) : env(env), deferred(deferred), context(AsyncContext::Get(env)), failed(false), keep_deferred(false) {
         }
 
     /**
@@ -21,7 +22,7 @@ namespace netcdf4async {
      */
     AsyncPromiseWorker::AsyncPromiseWorker(
         Napi::Env &env
-        ) : Napi::AsyncWorker(env), deferred(Napi::Promise::Deferred::New(env)) {
+        ) : env(env), deferred(Napi::Promise::Deferred::New(env)), context(AsyncContext::Get(env)), failed(false), keep_deferred(false) {
         }
 
     /**
@@ -30,6 +31,7 @@ namespace netcdf4async {
      * @param error Error
      */
     void AsyncPromiseWorker::OnError(Napi::Error const &error) {
+        Release();
         auto deferred=Deferred();
         deferred.Reject(error.Value());
     }
@@ -42,4 +44,384 @@ namespace netcdf4async {
     Napi::Promise::Deferred AsyncPromiseWorker::Deferred() {
         return deferred;
     }
+
+    /**
+     * @brief Return NodeJS environment
+     * 
+     * @return Napi::Env 
+     */
+    Napi::Env AsyncPromiseWorker::Env() const {
+        return env;
+    }
+
+    /**
+     * @brief Queue worker directly to I/O thread pool
+     * 
+     */
+    void AsyncPromiseWorker::Queue() {
+        context->Started(env);
+        NCThreadPool::Instance().Post(this);
+    }
+
+    /**
+     * @brief Queue worker through file executor
+     * 
+     * @param ncid NetCDF file or group id
+     */
+    void AsyncPromiseWorker::Queue(int ncid) {
+        executor=find_executor(ncid);
+        if (executor && executor->GetState() == NCExecutor::CLOSING) {
+            // Id could belong to other file once close is done, so worker must not run
+            executor.reset();
+            SetError("File already closed");
+            Queue();
+        }
+        else if (executor) {
+            executor->Post(this);
+        }
+        else {
+            Queue();
+        }
+    }
+
+    /**
+     * @brief Queue worker through file executor, rejecting it if File object is closed
+     * Executor of pooled handle stays open when one of Files sharing it is closed
+     * @param ncid NetCDF file or group id
+     * @param token Closed flag of File object
+     */
+    void AsyncPromiseWorker::Queue(int ncid, const FileToken &token) {
+        if (token && *token) {
+            SetError("File already closed");
+            Queue();
+            return;
+        }
+        Queue(ncid);
+    }
+
+    /**
+     * @brief Execute worker job and send worker back to main thread
+     * Exceptions thrown by job are stored as error message
+     */
+    void AsyncPromiseWorker::Run() {
+        try {
+            if (!failed) {
+                if (executor && !keep_deferred) {
+                    executor->Prepare();
+                }
+                Execute();
+            }
+        } catch (const std::exception &e) {
+            SetError(e.what());
+        } catch (...) {
+            SetError("Unknown error");
+        }
+        context->Deliver(this);
+    }
+
+    /**
+     * @brief Resolve or reject promise in main thread and destroy worker
+     * 
+     */
+    void AsyncPromiseWorker::Complete() {
+        // Exceptions must not leave thread-safe function callback, so reject promise instead
+        try {
+            if (failed) {
+                OnError(Napi::Error::New(env, error));
+            }
+            else {
+                OnOK();
+            }
+        } catch (const Napi::Error &e) {
+            Release();
+            deferred.Reject(e.Value());
+        } catch (const std::exception &e) {
+            Release();
+            deferred.Reject(Napi::Error::New(env, e.what()).Value());
+        }
+        context->Finished(env);
+        delete this;
+    }
+
+    /**
+     * @brief Mark job as failed
+     * 
+     * @param error Error message
+     */
+    void AsyncPromiseWorker::SetError(const std::string &error) {
+        this->failed=true;
+        this->error=error;
+    }
+
+    /**
+     * @brief Release executor
+     * Must be called once in main thread after worker's netcdf job is done
+     */
+    void AsyncPromiseWorker::Release() {
+        if (executor) {
+            auto current=executor;
+            executor.reset();
+            current->Release();
+        }
+    }
+
+    void AsyncPromiseWorker::Detach() {
+        executor.reset();
+    }
+
+    void AsyncPromiseWorker::KeepDeferred() {
+        keep_deferred=true;
+    }
+
+    NCThreadPool::NCThreadPool() : size(default_io_threads), running(0) {
+    }
+
+    /**
+     * @brief Pool instance
+     * Pool is never destroyed, its threads are detached and live until process exit
+     * @return NCThreadPool& 
+     */
+    NCThreadPool &NCThreadPool::Instance() {
+        static NCThreadPool *pool=new NCThreadPool();
+        return *pool;
+    }
+
+    /**
+     * @brief Put worker into queue and wake up one thread
+     * 
+     * @param worker 
+     */
+    void NCThreadPool::Post(AsyncPromiseWorker *worker) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            queue.push_back(worker);
+            Start();
+        }
+        ready.notify_one();
+    }
+
+    /**
+     * @brief Change number of threads
+     * Extra threads are stopped after they finish current job
+     * @param size 
+     */
+    void NCThreadPool::Resize(size_t size) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            this->size=size;
+            if (running>0) {
+                Start();
+            }
+        }
+        ready.notify_all();
+    }
+
+    size_t NCThreadPool::Size() {
+        std::lock_guard<std::mutex> guard(lock);
+        return size;
+    }
+
+    /**
+     * @brief Start missing threads. Must be called under pool lock
+     * 
+     */
+    void NCThreadPool::Start() {
+        while (running<size) {
+            std::thread(&NCThreadPool::Run, this).detach();
+            running++;
+        }
+    }
+
+    /**
+     * @brief Thread loop
+     * 
+     */
+    void NCThreadPool::Run() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            ready.wait(guard, [this] { return !queue.empty() || running>size; });
+            if (running>size) {
+                running--;
+                return;
+            }
+            AsyncPromiseWorker *worker=queue.front();
+            queue.pop_front();
+            guard.unlock();
+            worker->Run();
+            guard.lock();
+        }
+    }
+
+    /**
+     * @brief Create thread-safe function which calls Complete of delivered workers
+     * 
+     * @param env NodeJS environment
+     */
+    void AsyncContext::Init(Napi::Env env) {
+        AsyncContext *context=new AsyncContext();
+        context->pending=0;
+        context->tsfn=Napi::ThreadSafeFunction::New(
+            env,
+            Napi::Function::New(env, [] (const Napi::CallbackInfo &info) {}),
+            "netcdf4-async",
+            0,
+            1
+        );
+        context->tsfn.Unref(env);
+        env.SetInstanceData<AsyncContext>(context);
+    }
+
+    AsyncContext *AsyncContext::Get(Napi::Env env) {
+        return env.GetInstanceData<AsyncContext>();
+    }
+
+    /**
+     * @brief Keep event loop alive while there is a job in progress
+     * 
+     * @param env 
+     */
+    void AsyncContext::Started(Napi::Env env) {
+        if (pending++==0) {
+            tsfn.Ref(env);
+        }
+    }
+
+    /**
+     * @brief Allow event loop to exit when last job completed
+     * 
+     * @param env 
+     */
+    void AsyncContext::Finished(Napi::Env env) {
+        if (--pending==0) {
+            tsfn.Unref(env);
+        }
+    }
+
+    void AsyncContext::Deliver(AsyncPromiseWorker *worker) {
+        tsfn.BlockingCall(worker, [] (Napi::Env env, Napi::Function callback, AsyncPromiseWorker *worker) {
+            worker->Complete();
+        });
+    }
+
+    /**
+     * @brief Process-wide libnetcdf lock
+     * 
+     * @return std::mutex& 
+     */
+    std::mutex &netcdf_lock() {
+        static std::mutex lock;
+        return lock;
+    }
+
+    /// @brief Number of executor registry shards
+    static const size_t executor_shards=16;
+
+    /// @brief Part of executor registry with its own lock
+    struct ExecutorShard {
+        std::mutex lock;
+        std::map<int, std::shared_ptr<NCExecutor>> executors;
+    };
+
+    /**
+     * @brief Shard of file. libnetcdf gives files consecutive indexes, so they are spread evenly
+     * @param ncid NetCDF file or group id
+     */
+    static ExecutorShard &executor_shard(int ncid) {
+        static ExecutorShard *shards=new ExecutorShard[executor_shards];
+        return shards[(static_cast<unsigned>(NC_FILE_ID(ncid)) >> 16) % executor_shards];
+    }
+
+    NCExecutor::NCExecutor(int id) : id(id), busy(false), state(DATA), barriers(0) {
+    }
+
+    /**
+     * @brief Post worker
+     * Start worker if no other worker of this file in progress, otherwise put it to queue
+     * @param worker 
+     */
+    void NCExecutor::Post(AsyncPromiseWorker *worker) {
+        if (worker->AsHyperslabRead() == nullptr) {
+            barriers++;
+        }
+        if (busy) {
+            queue.push_back(worker);
+            return;
+        }
+        busy=true;
+        worker->Queue();
+    }
+
+    /**
+     * @brief Start next pending worker if any
+     * 
+     */
+    void NCExecutor::Release() {
+        if (queue.empty()) {
+            busy=false;
+            return;
+        }
+        AsyncPromiseWorker *worker=queue.front();
+        queue.pop_front();
+        worker->Absorb(queue);
+        worker->Queue();
+    }
+
+    size_t NCExecutor::Pending() const {
+        return queue.size();
+    }
+
+    int NCExecutor::Id() const {
+        return id;
+    }
+
+    uint64_t NCExecutor::Barriers() const {
+        return barriers;
+    }
+
+    bool NCExecutor::Idle() const {
+        return !busy;
+    }
+
+    NCExecutor::State NCExecutor::GetState() const {
+        return state;
+    }
+
+    void NCExecutor::SetState(State state) {
+        this->state=state;
+    }
+
+    void NCExecutor::Defer(std::function<void()> open) {
+        deferred_open=open;
+    }
+
+    /**
+     * @brief Open file postponed by metadata index
+     * Failed open is kept, so next operation tries again
+     */
+    void NCExecutor::Prepare() {
+        if (!deferred_open) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(netcdf_lock());
+        deferred_open();
+        deferred_open=nullptr;
+    }
+
+    std::shared_ptr<NCExecutor> register_executor(int id) {
+        auto executor=std::make_shared<NCExecutor>(id);
+        ExecutorShard &shard=executor_shard(id);
+        std::lock_guard<std::mutex> lock(shard.lock);
+        shard.executors[NC_FILE_ID(id)]=executor;
+        return executor;
+    }
+
+    std::shared_ptr<NCExecutor> find_executor(int ncid) {
+        ExecutorShard &shard=executor_shard(ncid);
+        std::lock_guard<std::mutex> lock(shard.lock);
+        auto it=shard.executors.find(NC_FILE_ID(ncid));
+        if (it==shard.executors.end()) {
+            return std::shared_ptr<NCExecutor>();
+        }
+        return it->second;
+    }
 }
@@ -6,6 +6,11 @@
 #include <string>
 #include <memory>
 #include <stdexcept>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
 
 #define NC_CALL(FN)                                                                                \
 	do {                                                                                           \
@@ -23,14 +28,106 @@
 		}                                                                                          \
 	} while (false);
 
+/// @brief Root (file) id for any group id of the file.
+/// libnetcdf keeps file index in high 16 bits of ncid and group index in low ones
+#define NC_FILE_ID(ID) ((ID) & ~0xFFFF)
+
 
 namespace netcdf4async {
 
+    class AsyncPromiseWorker;
+    class AsyncContext;
+    class HyperslabReadWorker;
+
+    /// @brief Process-wide lock for all libnetcdf calls
+    /// libnetcdf/HDF5 are not thread safe, so only one worker may be inside the library at once
+    /// @return lock
+    std::mutex &netcdf_lock();
+
+    /**
+     * @brief Per-file serial executor (strand)
+     * All workers of one file are queued into addon I/O thread pool (NCThreadPool) one after another,
+     * in the order they were posted. Next worker is queued as soon as previous one finished
+     * netcdf part of job, so result marshalling in main thread overlaps with next netcdf call.
+     * Both Post and Release are called in main thread only.
+     */
+    class NCExecutor {
+        public:
+            /// @brief State of file
+            enum State {
+                /// @brief File is in define mode, e.g. just created
+                DEFINE,
+                /// @brief File is in data mode
+                DATA,
+                /// @brief Close is queued, new operations are rejected
+                CLOSING
+            };
+            /// @brief Constructor
+            /// @param id NetCDF file id
+            explicit NCExecutor(int id);
+            /// @brief Post worker to executor. Worker queued immediately if executor is idle
+            /// @param worker Worker
+            void Post(AsyncPromiseWorker *worker);
+            /// @brief Notify executor what current worker finished. Queue next pending worker
+            void Release();
+            /// @brief Number of workers waiting in executor queue
+            /// @return queue length
+            size_t Pending() const;
+            /// @brief NetCDF file id
+            /// @return file id
+            int Id() const;
+            /// @brief Number of posted workers which are not hyperslab reads
+            /// Read results could be shared only between reads with no other operation in between
+            /// @return counter
+            uint64_t Barriers() const;
+            /// @brief Postpone real open of file until first worker which needs it.
+            /// Called in main thread before any worker is posted
+            /// @param open Function opening file, called with netcdf lock held
+            void Defer(std::function<void()> open);
+            /// @brief Run postponed open, if any. Called in I/O thread before worker job,
+            /// workers of one file never run at once, so no extra lock is needed
+            void Prepare();
+            /// @brief No worker of file is running or waiting
+            /// @return true if executor is idle
+            bool Idle() const;
+            /// @brief Current state of file. Changed in main thread only
+            /// @return state
+            State GetState() const;
+            /// @brief Change state of file
+            /// @param state New state
+            void SetState(State state);
+        private:
+            int id;
+            bool busy;
+            State state;
+            uint64_t barriers;
+            std::deque<AsyncPromiseWorker *> queue;
+            std::function<void()> deferred_open;
+    };
+
+    /// @brief Create and register executor for opened file, replacing executor of closed file with the same id.
+    /// Executors of closed files stay registered in CLOSING state, so late operations of their groups
+    /// and variables are rejected. Registry is sharded by file id, so lookups of different files do not contend
+    /// @param id NetCDF file id
+    /// @return Executor
+    std::shared_ptr<NCExecutor> register_executor(int id);
+    /// @brief Find executor of file which owns group
+    /// @param ncid NetCDF file or group id
+    /// @return Executor or empty pointer if file was never opened through File
+    std::shared_ptr<NCExecutor> find_executor(int ncid);
+
+    /// @brief Closed flag of one File object, shared with its groups and variables.
+    /// Files sharing pooled handle share its executor too, which is not closed with them
+    typedef std::shared_ptr<bool> FileToken;
+
     /**
      * @brief Asynchronus promise worker
-     * Provide some basic functionality for promises
+     * Provide some basic functionality for promises.
+     * Worker job runs in addon own I/O thread pool, not in libuv one,
+     * so NetCDF reads do not compete with fs, dns, zlib and crypto.
+     * Completion is delivered back to main thread through thread-safe function
      */
-    class AsyncPromiseWorker : public Napi::AsyncWorker {
+    class AsyncPromiseWorker {
         public:
             /// @brief Constructor
             /// @param env NodeJS environment
@@ -42,18 +139,123 @@ namespace netcdf4async {
 
             
             /// @brief Destroy the Async Promise Worker object
-            ~AsyncPromiseWorker() override { };
+            virtual ~AsyncPromiseWorker() { };
             /// @brief Default OnError handler. Rejects promise
             /// @param error Error
-            void OnError(Napi::Error const &error) override;
+            virtual void OnError(Napi::Error const &error);
             /// @brief Getter for deferred
             /// @return Deferred promise object
             Napi::Promise::Deferred Deferred();
+            /// @brief NodeJS environment of worker
+            /// @return env
+            Napi::Env Env() const;
+            /// @brief Queue worker to I/O thread pool
+            void Queue();
+            /// @brief Queue worker through executor of file which owns ncid
+            /// Falls back to plain pool queue if file is not registered.
+            /// Worker is rejected without running if file is closing
+            /// @param ncid NetCDF file or group id
+            void Queue(int ncid);
+            /// @brief Queue worker through executor of file which owns ncid, unless File object is closed
+            /// @param ncid NetCDF file or group id
+            /// @param token Closed flag of File object, see FileToken
+            void Queue(int ncid, const FileToken &token);
+            /// @brief Run worker job. Called in I/O thread
+            void Run();
+            /// @brief Finish worker: resolve/reject promise and destroy worker. Called in main thread
+            void Complete();
+            /// @brief Take compatible workers waiting right after this one in executor queue,
+            /// so they are served by this worker. Called in main thread before worker starts
+            /// @param queue Executor queue
+            virtual void Absorb(std::deque<AsyncPromiseWorker *> &queue) { };
+            /// @brief Worker as hyperslab read, used to find reads which could be merged
+            /// @return worker or nullptr if it is not a hyperslab read
+            virtual HyperslabReadWorker *AsHyperslabRead() { return nullptr; };
+            /// @brief Run worker without opening file postponed by metadata index, e.g. to close it
+            void KeepDeferred();
+        protected:
+            /// @brief Worker job. Executed in I/O thread
+            virtual void Execute() = 0;
+            /// @brief Handler if job finished successfully
+            virtual void OnOK() = 0;
+            /// @brief Mark job as failed
+            /// @param error Error message
+            void SetError(const std::string &error);
+            /// @brief Leave executor and let next worker of the same file run
+            void Release();
+            /// @brief Forget executor of worker served by another one, so it does not release it
+            void Detach();
         private:
+            Napi::Env env;
             Napi::Promise::Deferred deferred;
+            AsyncContext *context;
+            std::shared_ptr<NCExecutor> executor;
+            bool failed;
+            bool keep_deferred;
+            std::string error;
 
     };
 
+    /**
+     * @brief Addon own I/O thread pool
+     * Process-wide pool which executes worker jobs.
+     * Size could be changed at any time through `configure({ioThreads})`
+     */
+    class NCThreadPool {
+        public:
+            /// @brief Pool instance
+            /// @return pool
+            static NCThreadPool &Instance();
+            /// @brief Put worker into pool queue. Threads are started lazily
+            /// @param worker Worker
+            void Post(AsyncPromiseWorker *worker);
+            /// @brief Change number of threads
+            /// @param size New number of threads, must be positive
+            void Resize(size_t size);
+            /// @brief Number of threads
+            /// @return pool size
+            size_t Size();
+        private:
+            NCThreadPool();
+            void Start();
+            void Run();
+            std::mutex lock;
+            std::condition_variable ready;
+            std::deque<AsyncPromiseWorker *> queue;
+            size_t size;
+            size_t running;
+    };
+
+    /// @brief Default size of I/O thread pool
+    const size_t default_io_threads=4;
+
+    /**
+     * @brief Per environment async context
+     * Holds thread-safe function used to deliver completed workers to main thread
+     */
+    class AsyncContext {
+        public:
+            /// @brief Create context and attach it to environment
+            /// @param env NodeJS environment
+            static void Init(Napi::Env env);
+            /// @brief Context of environment
+            /// @param env NodeJS environment
+            /// @return context
+            static AsyncContext *Get(Napi::Env env);
+            /// @brief Worker started. Keeps event loop alive while jobs are in progress
+            /// @param env NodeJS environment
+            void Started(Napi::Env env);
+            /// @brief Worker completed
+            /// @param env NodeJS environment
+            void Finished(Napi::Env env);
+            /// @brief Send completed worker to main thread. Called in I/O thread
+            /// @param worker Worker
+            void Deliver(AsyncPromiseWorker *worker);
+        private:
+            Napi::ThreadSafeFunction tsfn;
+            size_t pending;
+    };
+
     // /**
     //  * @brief Construct a new Async Promise Worker:: Async Promise Worker object
     //  * 
@@ -203,11 +405,12 @@ namespace netcdf4async {
 
     /**
      * @brief Execute async operation
-     * Executes doit function and save result of execution
+     * Executes doit function under libnetcdf lock and save result of execution
      * @tparam NetCDFType 
      */
     template<class NetCDFType> void NCAsyncWorker<NetCDFType>::Execute() {
         try {
+            std::lock_guard<std::mutex> lock(netcdf_lock());
             NetCDFType result=doit(this);
             setResult(result);
         } catch (const char *err) { 
@@ -221,6 +424,7 @@ namespace netcdf4async {
      * @tparam NetCDFType 
      */
     template<class NetCDFType> void NCAsyncWorker<NetCDFType>::OnOK() {
+        Release();
         auto env=Env();
         Napi::Promise::Deferred deferred=Deferred();
         try {
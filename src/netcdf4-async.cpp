@@ -3,6 +3,17 @@
 #include <netcdf_meta.h>
 #include <memory>
 #include "netcdf4-async.h"
+#include "async.h"
+#include "SharedMemory.h"
+#include "Macros.h"
+#include "Coalescer.h"
+#include "ResultCache.h"
+#include "Scanner.h"
+#include "MetadataIndex.h"
+#include "HandlePool.h"
+#include "ClassicReader.h"
+#include "ChunkEngine.h"
+#include "Decimator.h"
 // #include "worker.h"
 
 
@@ -57,6 +68,191 @@ Napi::Value open(const Napi::CallbackInfo& info) {
 
 }
 
+/**
+ * @brief Async open file held in Buffer
+ * 
+ * @param info 
+ * @return Napi::Value Returns Promise object
+ */
+Napi::Value open_buffer(const Napi::CallbackInfo& info) {
+    return File::OpenBuffer(info);
+}
+
+/**
+ * @brief Async create file in memory
+ * 
+ * @param info 
+ * @return Napi::Value Returns Promise object
+ */
+Napi::Value create_buffer(const Napi::CallbackInfo& info) {
+    return File::CreateBuffer(info);
+}
+
+/**
+ * @brief Get/set addon settings
+ * Accepts optional object with settings to change:
+ * * `ioThreads` : size of addon I/O thread pool
+ * * `bufferPoolSize` : capacity of read buffer pool in bytes
+ * * `coalesce` : merge queued reads of neighbouring hyperslabs
+ * * `coalesceGap` : max distance in elements between merged hyperslabs
+ * * `singleFlight` : attach reads to identical read in flight
+ * * `singleFlightShared` : attached reads get the same TypedArray instead of own copy
+ * * `cacheSize` : capacity of read result cache in bytes, 0 disables cache
+ * * `handlePoolSize` : max number of idle read only handles kept open, 0 disables handle pool
+ * * `decimate` : read strided hyperslabs as bounding box decimated in memory when it is cheaper
+ * * `chunkThreads` : number of threads inflating and deflating chunks of deflated variables, 0 disables chunk engine
+ * @param info 
+ * @return Napi::Value Object with current settings
+ */
+Napi::Value configure(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() > 0 && !(info[0].IsUndefined() || info[0].IsNull())) {
+        if (!info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expecting an object with settings").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Has("ioThreads")) {
+            Napi::Value value = options.Get("ioThreads");
+            if (!value.IsNumber() || value.As<Napi::Number>().Int64Value() < 1) {
+                Napi::TypeError::New(env, "ioThreads must be a positive integer").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            NCThreadPool::Instance().Resize(static_cast<size_t>(value.As<Napi::Number>().Int64Value()));
+        }
+        if (options.Has("bufferPoolSize")) {
+            Napi::Value value = options.Get("bufferPoolSize");
+            if (!value.IsNumber() || value.As<Napi::Number>().Int64Value() < 0) {
+                Napi::TypeError::New(env, "bufferPoolSize must be a non-negative integer").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            BufferPool::Instance().Resize(static_cast<size_t>(value.As<Napi::Number>().Int64Value()));
+        }
+        if (options.Has("coalesce")) {
+            coalesce_enabled = options.Get("coalesce").ToBoolean().Value();
+        }
+        if (options.Has("coalesceGap")) {
+            Napi::Value value = options.Get("coalesceGap");
+            if (!value.IsNumber() || value.As<Napi::Number>().Int64Value() < 0) {
+                Napi::TypeError::New(env, "coalesceGap must be a non-negative integer").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            coalesce_gap = static_cast<size_t>(value.As<Napi::Number>().Int64Value());
+        }
+        if (options.Has("singleFlight")) {
+            single_flight_enabled = options.Get("singleFlight").ToBoolean().Value();
+        }
+        if (options.Has("singleFlightShared")) {
+            single_flight_shared = options.Get("singleFlightShared").ToBoolean().Value();
+        }
+        if (options.Has("cacheSize")) {
+            Napi::Value value = options.Get("cacheSize");
+            if (!value.IsNumber() || value.As<Napi::Number>().Int64Value() < 0) {
+                Napi::TypeError::New(env, "cacheSize must be a non-negative integer").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            ResultCache::Instance().Resize(static_cast<size_t>(value.As<Napi::Number>().Int64Value()));
+        }
+        if (options.Has("handlePoolSize")) {
+            Napi::Value value = options.Get("handlePoolSize");
+            if (!value.IsNumber() || value.As<Napi::Number>().Int64Value() < 0) {
+                Napi::TypeError::New(env, "handlePoolSize must be a non-negative integer").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            HandlePool::Instance().Resize(static_cast<size_t>(value.As<Napi::Number>().Int64Value()));
+            HandlePool::Instance().Evict(env);
+        }
+        if (options.Has("decimate")) {
+            decimate_enabled = options.Get("decimate").ToBoolean().Value();
+        }
+        if (options.Has("chunkThreads")) {
+            Napi::Value value = options.Get("chunkThreads");
+            if (!value.IsNumber() || value.As<Napi::Number>().Int64Value() < 0) {
+                Napi::TypeError::New(env, "chunkThreads must be a non-negative integer").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            ChunkThreads::Instance().Resize(static_cast<size_t>(value.As<Napi::Number>().Int64Value()));
+        }
+    }
+    Napi::Object settings = Napi::Object::New(env);
+    settings.Set("ioThreads", Napi::Number::New(env, NCThreadPool::Instance().Size()));
+    settings.Set("bufferPoolSize", Napi::Number::New(env, BufferPool::Instance().Capacity()));
+    settings.Set("coalesce", Napi::Boolean::New(env, coalesce_enabled));
+    settings.Set("coalesceGap", Napi::Number::New(env, static_cast<double>(coalesce_gap)));
+    settings.Set("singleFlight", Napi::Boolean::New(env, single_flight_enabled));
+    settings.Set("singleFlightShared", Napi::Boolean::New(env, single_flight_shared));
+    settings.Set("cacheSize", Napi::Number::New(env, ResultCache::Instance().Capacity()));
+    settings.Set("handlePoolSize", Napi::Number::New(env, HandlePool::Instance().Capacity()));
+    settings.Set("decimate", Napi::Boolean::New(env, decimate_enabled));
+    settings.Set("chunkThreads", Napi::Number::New(env, ChunkThreads::Instance().Size()));
+    settings.Set("chunkEngine", Napi::Boolean::New(env, chunk_engine_available()));
+    settings.Set("externalBuffers", Napi::Boolean::New(env, external_buffers));
+    return settings;
+}
+
+/**
+ * @brief Get addon runtime counters
+ * @param info 
+ * @return Napi::Value Object with `bufferPool`, `coalescer`, `singleFlight`, `cache`, `metadataIndex`, `handlePool`, `nativeReader`, `chunkEngine` and `decimation` counters
+ */
+Napi::Value stats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    BufferPool &pool = BufferPool::Instance();
+    Napi::Object buffer_pool = Napi::Object::New(env);
+    buffer_pool.Set("hits", Napi::Number::New(env, static_cast<double>(pool.Hits())));
+    buffer_pool.Set("misses", Napi::Number::New(env, static_cast<double>(pool.Misses())));
+    buffer_pool.Set("cached", Napi::Number::New(env, pool.Cached()));
+    buffer_pool.Set("capacity", Napi::Number::New(env, pool.Capacity()));
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("bufferPool", buffer_pool);
+    Napi::Object coalescer = Napi::Object::New(env);
+    coalescer.Set("batches", Napi::Number::New(env, static_cast<double>(coalesced_batches)));
+    coalescer.Set("merged", Napi::Number::New(env, static_cast<double>(coalesced_requests)));
+    result.Set("coalescer", coalescer);
+    Napi::Object single_flight = Napi::Object::New(env);
+    single_flight.Set("hits", Napi::Number::New(env, static_cast<double>(single_flight_hits)));
+    result.Set("singleFlight", single_flight);
+    uint64_t hits, misses, evictions;
+    size_t size, entries;
+    ResultCache::Instance().Stats(hits, misses, evictions, size, entries);
+    Napi::Object cache = Napi::Object::New(env);
+    cache.Set("hits", Napi::Number::New(env, static_cast<double>(hits)));
+    cache.Set("misses", Napi::Number::New(env, static_cast<double>(misses)));
+    cache.Set("evictions", Napi::Number::New(env, static_cast<double>(evictions)));
+    cache.Set("size", Napi::Number::New(env, size));
+    cache.Set("entries", Napi::Number::New(env, entries));
+    result.Set("cache", cache);
+    Napi::Object metadata_index = Napi::Object::New(env);
+    metadata_index.Set("hits", Napi::Number::New(env, static_cast<double>(metadata_index_hits.load())));
+    metadata_index.Set("misses", Napi::Number::New(env, static_cast<double>(metadata_index_misses.load())));
+    metadata_index.Set("deferredOpens", Napi::Number::New(env, static_cast<double>(metadata_index_deferred_opens.load())));
+    result.Set("metadataIndex", metadata_index);
+    size_t open, idle;
+    HandlePool::Instance().Stats(hits, misses, evictions, open, idle);
+    Napi::Object handle_pool = Napi::Object::New(env);
+    handle_pool.Set("hits", Napi::Number::New(env, static_cast<double>(hits)));
+    handle_pool.Set("misses", Napi::Number::New(env, static_cast<double>(misses)));
+    handle_pool.Set("evictions", Napi::Number::New(env, static_cast<double>(evictions)));
+    handle_pool.Set("open", Napi::Number::New(env, open));
+    handle_pool.Set("idle", Napi::Number::New(env, idle));
+    result.Set("handlePool", handle_pool);
+    Napi::Object native_reader = Napi::Object::New(env);
+    native_reader.Set("reads", Napi::Number::New(env, static_cast<double>(classic_reader_reads.load())));
+    native_reader.Set("views", Napi::Number::New(env, static_cast<double>(classic_reader_views.load())));
+    result.Set("nativeReader", native_reader);
+    Napi::Object chunk_engine = Napi::Object::New(env);
+    chunk_engine.Set("reads", Napi::Number::New(env, static_cast<double>(chunk_engine_reads.load())));
+    chunk_engine.Set("writes", Napi::Number::New(env, static_cast<double>(chunk_engine_writes.load())));
+    chunk_engine.Set("chunks", Napi::Number::New(env, static_cast<double>(chunk_engine_chunks.load())));
+    chunk_engine.Set("fallbacks", Napi::Number::New(env, static_cast<double>(chunk_engine_fallbacks.load())));
+    result.Set("chunkEngine", chunk_engine);
+    Napi::Object decimation = Napi::Object::New(env);
+    decimation.Set("reads", Napi::Number::New(env, static_cast<double>(decimated_reads.load())));
+    decimation.Set("direct", Napi::Number::New(env, static_cast<double>(strided_reads.load())));
+    result.Set("decimation", decimation);
+    return result;
+}
+
 /**
  * @brief Initialize class as NodeJS object
  * 
@@ -73,6 +269,16 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
 	exports.Set("version",version);
 
 	exports.Set(Napi::String::New(env, "open"), Napi::Function::New<open>(env));	
+	exports.Set(Napi::String::New(env, "openBuffer"), Napi::Function::New<open_buffer>(env));
+	exports.Set(Napi::String::New(env, "createBuffer"), Napi::Function::New<create_buffer>(env));
+	exports.Set(Napi::String::New(env, "configure"), Napi::Function::New<configure>(env));
+	exports.Set(Napi::String::New(env, "stats"), Napi::Function::New<stats>(env));
+	exports.Set(Napi::String::New(env, "createShared"), Napi::Function::New<create_shared>(env));
+	exports.Set(Napi::String::New(env, "attachShared"), Napi::Function::New<attach_shared>(env));
+	exports.Set(Napi::String::New(env, "unlinkShared"), Napi::Function::New<unlink_shared>(env));
+	exports.Set(Napi::String::New(env, "scanBatch"), Napi::Function::New<scan_batch>(env));
+	AsyncContext::Init(env);
+	detectExternalBuffers(env);
 	File::Init(env);
 	Group::Init(env);
 //	Dimension::Init(env, exports);
@@ -5,6 +5,7 @@
 #include <netcdf.h>
 #include <string>
 #include <memory>
+#include <vector>
 #include <stdexcept>
 #include <mutex>
 #include <shared_mutex>
@@ -18,6 +19,9 @@ namespace netcdf4async {
   /// @brief List of file format names
   extern const char *type_names[];
 
+  class NCExecutor;
+  struct Hyperslab;
+
 /// @brief NetCDF file implementation
 class File : public Napi::ObjectWrap<File> {
   public:
@@ -30,6 +34,14 @@ class File : public Napi::ObjectWrap<File> {
 	/// @param info 
 	/// @return Deferred promise
 	static Napi::Value Open (const Napi::CallbackInfo& info);
+	/// @brief Async open of NetCDF file held in Buffer
+	/// @param info 
+	/// @return Deferred promise
+	static Napi::Value OpenBuffer (const Napi::CallbackInfo& info);
+	/// @brief Async create of NetCDF file in memory
+	/// @param info 
+	/// @return Deferred promise
+	static Napi::Value CreateBuffer (const Napi::CallbackInfo& info);
 
     /// @brief Construct a new File object
     /// Construct NodeJS wrapper for netcdf file.
@@ -61,6 +73,16 @@ class File : public Napi::ObjectWrap<File> {
 	Napi::Object group;
 	/// @brief Is file close
 	bool closed;
+	/// @brief Closed flag shared with groups and variables of file, see FileToken
+	std::shared_ptr<bool> token;
+	/// @brief Serial executor for all operations on this file
+	std::shared_ptr<NCExecutor> executor;
+	/// @brief Handle is shared through handle pool, it is released instead of closing
+	bool pooled;
+	/// @brief File is opened from or created in memory
+	bool in_memory;
+	/// @brief Buffer read only file uses without copy, kept until file is closed
+	std::shared_ptr<Napi::ObjectReference> memory;
 
 	/// @brief Created and added default group to File
 	/// @param env 
@@ -82,6 +104,18 @@ class File : public Napi::ObjectWrap<File> {
 	/// @param info 
 	/// @return Deferred promise
 	Napi::Value DataMode(const Napi::CallbackInfo &info);
+	/// @brief Find variable, group or dimension by full path
+	/// @param info 
+	/// @return Deferred promise
+	Napi::Value Get(const Napi::CallbackInfo &info);
+	/// @brief Dump metadata of whole file
+	/// @param info 
+	/// @return Deferred promise
+	Napi::Value Describe(const Napi::CallbackInfo &info);
+	/// @brief Close in-memory file and return its contents
+	/// @param info 
+	/// @return Deferred promise
+	Napi::Value ToBuffer(const Napi::CallbackInfo &info);
 	/// @brief Return file path
 	/// @param info 
 	/// @return NodeJS String
@@ -90,6 +124,10 @@ class File : public Napi::ObjectWrap<File> {
 	/// @param info 
 	/// @return NodeJS boolean
 	Napi::Value IsClosed(const Napi::CallbackInfo &info);
+	/// @brief Is file in define mode
+	/// @param info 
+	/// @return NodeJS boolean
+	Napi::Value IsDefineMode(const Napi::CallbackInfo &info);
 	/// @brief File format
 	/// @see *format_names
 	/// @param info 
@@ -106,7 +144,7 @@ class Group : public Napi::ObjectWrap<Group> {
   public:
 	Group(const Napi::CallbackInfo &info);
 	static void Init(Napi::Env env);
-	static Napi::Object Build(Napi::Env env, int id, std::string name);
+	static Napi::Object Build(Napi::Env env, int id, std::string name, const std::shared_ptr<bool> &token);
 	bool get_name(char *name) const;
 	void set_name(std::string groupname);
 
@@ -125,6 +163,7 @@ class Group : public Napi::ObjectWrap<Group> {
 	Napi::Value GetVariables(const Napi::CallbackInfo &info);
 	Napi::Value GetVariable(const Napi::CallbackInfo &info);
 	Napi::Value AddVariable(const Napi::CallbackInfo &info);
+	Napi::Value ReadVariables(const Napi::CallbackInfo &info);
 
 	Napi::Value GetDimensions(const Napi::CallbackInfo &info);
 	Napi::Value AddDimension(const Napi::CallbackInfo &info);
@@ -132,17 +171,24 @@ class Group : public Napi::ObjectWrap<Group> {
 	Napi::Value GetAttributes(const Napi::CallbackInfo &info);
 	Napi::Value AddAttribute(const Napi::CallbackInfo &info);
 
+	Napi::Value GetVariablesSync(const Napi::CallbackInfo &info);
+	Napi::Value GetDimensionsSync(const Napi::CallbackInfo &info);
+	Napi::Value GetSubgroupsSync(const Napi::CallbackInfo &info);
+	Napi::Value GetAttributesSync(const Napi::CallbackInfo &info);
+
 	Napi::Value Inspect(const Napi::CallbackInfo &info);
 
 	int id;
 	std::string name;
+	/// @brief Closed flag of file, see FileToken
+	std::shared_ptr<bool> token;
 };
 
 class Variable : public Napi::ObjectWrap<Variable> {
   public:
 	static void Init(Napi::Env env);
 	Variable(const Napi::CallbackInfo &info);
-	static Napi::Object Build(Napi::Env env, int id, int parent_id, std::string name, nc_type type, int ndims);
+	static Napi::Object Build(Napi::Env env, int id, int parent_id, std::string name, nc_type type, int ndims, const std::shared_ptr<bool> &token);
 	void set_name(std::string new_name);
 	
   private:
@@ -151,6 +197,11 @@ class Variable : public Napi::ObjectWrap<Variable> {
 	Napi::Value SetName(const Napi::CallbackInfo &info);
 	Napi::Value GetNameSync(const Napi::CallbackInfo &info);
 	Napi::Value GetTypeSync(const Napi::CallbackInfo &info);
+	Napi::Value GetShapeSync(const Napi::CallbackInfo &info);
+	Napi::Value GetDimensionsSync(const Napi::CallbackInfo &info);
+	Napi::Value GetChunkedSync(const Napi::CallbackInfo &info);
+	Napi::Value GetFillSync(const Napi::CallbackInfo &info);
+	Napi::Value GetAttributesSync(const Napi::CallbackInfo &info);
 
 	Napi::Value GetDimensions(const Napi::CallbackInfo &info);
 
@@ -161,6 +212,9 @@ class Variable : public Napi::ObjectWrap<Variable> {
 
 	Napi::Value GetChunked(const Napi::CallbackInfo &info);
 	Napi::Value SetChunked(const Napi::CallbackInfo &info);
+	Napi::Value GetChunkCache(const Napi::CallbackInfo &info);
+	Napi::Value SetChunkCache(const Napi::CallbackInfo &info);
+	void adaptChunkCache(const Hyperslab &slab);
 
 	Napi::Value GetDeflateInfo(const Napi::CallbackInfo &info);
 	Napi::Value SetDeflateInfo(const Napi::CallbackInfo &info);
@@ -180,6 +234,10 @@ class Variable : public Napi::ObjectWrap<Variable> {
 	Napi::Value Read(const Napi::CallbackInfo &info);
 	Napi::Value ReadSlice(const Napi::CallbackInfo &info);
 	Napi::Value ReadStridedSlice(const Napi::CallbackInfo &info);
+	Napi::Value ReadSliceInto(const Napi::CallbackInfo &info);
+	Napi::Value ReadStridedSliceInto(const Napi::CallbackInfo &info);
+	Napi::Value _readInto(const Napi::CallbackInfo &info, bool strided);
+	Napi::Value ReadSlices(const Napi::CallbackInfo &info);
 	Napi::Value Write(const Napi::CallbackInfo &info);
 	Napi::Value WriteSlice(const Napi::CallbackInfo &info);
 	Napi::Value WriteStridedSlice(const Napi::CallbackInfo &info);
@@ -192,6 +250,8 @@ class Variable : public Napi::ObjectWrap<Variable> {
 	nc_type type;
 	int ndims;
 	std::string name;
+	/// @brief Closed flag of file, see FileToken
+	std::shared_ptr<bool> token;
 };
 
 } // namespace netcdf4async
@@ -0,0 +1,148 @@
+const chai = require("chai");
+const expect = chai.expect;
+chai.use(require("chai-as-promised"));
+const netcdf4 = require("..");
+const {join} = require("path");
+const {newFile,closeAll} = require("./utils");
+const {tmpdir} = require("os");
+const {mkdtempSync, rmSync} = require("fs");
+
+describe("Configure", function () {
+    it("Returns current settings",function() {
+        const settings=netcdf4.configure();
+        expect(settings).to.have.property("ioThreads");
+        expect(settings.ioThreads).to.be.above(0);
+        expect(settings.externalBuffers).to.be.a("boolean");
+    });
+    it("Changes I/O thread pool size",function() {
+        const old=netcdf4.configure().ioThreads;
+        expect(netcdf4.configure({ioThreads:2})).to.deep.include({ioThreads:2});
+        expect(netcdf4.configure({ioThreads:old})).to.deep.include({ioThreads:old});
+    });
+    it("Rejects wrong I/O thread pool size",function() {
+        expect(()=>netcdf4.configure({ioThreads:0})).to.throw("ioThreads must be a positive integer");
+        expect(()=>netcdf4.configure({ioThreads:"many"})).to.throw("ioThreads must be a positive integer");
+    });
+    it("Changes buffer pool size",function() {
+        const old=netcdf4.configure().bufferPoolSize;
+        expect(netcdf4.configure({bufferPoolSize:0})).to.deep.include({bufferPoolSize:0});
+        expect(netcdf4.stats().bufferPool.cached).to.be.equal(0);
+        expect(netcdf4.configure({bufferPoolSize:old})).to.deep.include({bufferPoolSize:old});
+        expect(()=>netcdf4.configure({bufferPoolSize:-1})).to.throw("bufferPoolSize must be a non-negative integer");
+    });
+    it("Counts buffer pool usage",async function() {
+        const before=netcdf4.stats().bufferPool;
+        const file=await netcdf4.open(join(__dirname, "testrh.nc"),"r");
+        const variable=(await file.root.getVariables()).var1;
+        await variable.readSlice(0,1000);
+        await variable.readSlice(0,1000);
+        await file.close();
+        const after=netcdf4.stats().bufferPool;
+        expect(after.hits+after.misses).to.be.at.least(before.hits+before.misses+2);
+        expect(after.capacity).to.be.equal(netcdf4.configure().bufferPoolSize);
+    });
+    it("Returns written values to buffer pool",async function() {
+        const file=await newFile(join(__dirname, "test_hgroups.nc"));
+        try {
+            const variable=await file.root.addVariable("v","double",["recNum"]);
+            const values=new Float64Array(74).fill(1.5);
+            await variable.writeSlice(0,74,values);
+            await variable.write(0,2.5);
+            const before=netcdf4.stats().bufferPool;
+            for (let i=0;i<5;i++) {
+                await variable.writeSlice(0,74,values);
+                await variable.write(i,2.5);
+            }
+            expect(netcdf4.stats().bufferPool.misses).to.be.equal(before.misses);
+        } finally {
+            await closeAll();
+        }
+    });
+    it("Returns buffers of failed reads to pool",async function() {
+        const file=await netcdf4.open(join(__dirname, "testrh.nc"),"r");
+        const variable=(await file.root.getVariables()).var1;
+        try {
+            await expect(variable.readSlice(9998,4)).to.be.rejectedWith("exceeds dimension bound");
+            const before=netcdf4.stats().bufferPool;
+            for (let i=0;i<5;i++) {
+                await expect(variable.readSlice(9998,4)).to.be.rejectedWith("exceeds dimension bound");
+            }
+            expect(netcdf4.stats().bufferPool.misses).to.be.equal(before.misses);
+        } finally {
+            await file.close();
+        }
+    });
+    it("Shares pooled file handles",async function() {
+        const fixture=join(__dirname, "testrh.nc");
+        expect(netcdf4.configure({handlePoolSize:1})).to.deep.include({handlePoolSize:1});
+        try {
+            const before=netcdf4.stats().handlePool;
+            const file=await netcdf4.open(fixture,"r");
+            const shared=await netcdf4.open(fixture,"r");
+            expect(netcdf4.stats().handlePool.hits).to.be.equal(before.hits+1);
+            const {root}=file;
+            const variable=root.variables.var1;
+            await file.close();
+            await expect(variable.readSlice(0,4)).to.be.rejectedWith("File already closed");
+            await expect(root.getVariables()).to.be.rejectedWith("File already closed");
+            const values=await shared.root.variables.var1.readSlice(0,4);
+            expect(Array.from(values)).to.deep.equal([420,197,391.5,399]);
+            await shared.close();
+            expect(netcdf4.stats().handlePool.idle).to.be.equal(1);
+            const reopened=await netcdf4.open(fixture,"r");
+            expect(netcdf4.stats().handlePool.hits).to.be.equal(before.hits+2);
+            await reopened.close();
+        } finally {
+            netcdf4.configure({handlePoolSize:0});
+        }
+        expect(netcdf4.stats().handlePool.open).to.be.equal(0);
+        expect(()=>netcdf4.configure({handlePoolSize:-1})).to.throw("handlePoolSize must be a non-negative integer");
+    });
+    it("Decimates bounding box of strided reads",async function() {
+        const file=await netcdf4.open(join(__dirname, "testrh.nc"),"r");
+        const variable=file.root.variables.var1;
+        try {
+            const before=netcdf4.stats().decimation;
+            const decimated=await variable.readStridedSlice(1,2500,4);
+            expect(netcdf4.stats().decimation.reads).to.be.equal(before.reads+1);
+            expect(netcdf4.configure({decimate:false})).to.deep.include({decimate:false});
+            expect(await variable.readStridedSlice(1,2500,4)).to.deep.equal(decimated);
+            expect(netcdf4.stats().decimation.direct).to.be.equal(before.direct+1);
+            expect(decimated[0]).to.be.equal(197);
+        } finally {
+            netcdf4.configure({decimate:true});
+            await file.close();
+        }
+    });
+    it("Deflates and inflates chunks in parallel",async function() {
+        const dir=mkdtempSync(join(tmpdir(), "netcdf4-chunks-"));
+        const values=new Float32Array(1000).map((v,i)=>Math.sin(i)*100);
+        try {
+            expect(netcdf4.configure({chunkThreads:2})).to.deep.include({chunkThreads:2});
+            const before=netcdf4.stats().chunkEngine;
+            const path=join(dir, "deflated.nc");
+            const file=await netcdf4.open(path,"c!","netcdf4");
+            await file.root.addDimension("x",1000);
+            const variable=await file.root.addVariable("v","float",["x"]);
+            await variable.setChunked("chunked",new Uint32Array([100]));
+            await variable.setDeflateInfo(true,true,4);
+            await variable.writeSlice(0,1000,values);
+            await file.close();
+            const reopened=await netcdf4.open(path,"r");
+            expect(await reopened.root.variables.v.readSlice(150,700)).to.deep.equal(values.subarray(150,850));
+            if (netcdf4.configure().chunkEngine) {
+                const after=netcdf4.stats().chunkEngine;
+                expect(after.writes).to.be.equal(before.writes+1);
+                expect(after.reads).to.be.equal(before.reads+1);
+                expect(after.chunks).to.be.equal(before.chunks+18);
+            }
+            netcdf4.configure({chunkThreads:0});
+            expect(await reopened.root.variables.v.readSlice(0,1000)).to.deep.equal(values);
+            await reopened.close();
+        } finally {
+            netcdf4.configure({chunkThreads:0});
+            rmSync(dir, {recursive:true, force:true});
+        }
+        expect(()=>netcdf4.configure({chunkThreads:-1})).to.throw("chunkThreads must be a non-negative integer");
+    });
+});
@@ -5,6 +5,8 @@ chai.use(chaiAsPromised);
 
 const netcdf4 = require("..");
 const { join } = require("path");
+const { mkdtempSync, rmSync, readFileSync, writeFileSync, existsSync } = require("fs");
+const { tmpdir } = require("os");
 
 const fixture = join(__dirname, "testrh.nc");
 const fixture1 = join(__dirname, "test_hgroups.nc");
@@ -55,8 +57,143 @@ describe("File", async function () {
     const res=await expect(variables.var1.readSlice(0, 4)).to.be.fulfilled;
     const results = Array.from(res);
     expect(results).to.deep.equal([420, 197, 391.5, 399]);
+    const pending=variables.var1.readSlice(4, 4);
     await expect(file.close()).to.be.fulfilled;
+    await expect(pending).to.be.fulfilled;
+    await expect(variables.var1.readSlice(0, 4)).to.be.rejectedWith("File already closed");
     expect(file.closed).true;
     expect(file.root).is.undefined;
   });
+
+  it("should find objects by full path", async function () {
+    const file=await expect(netcdf4.open(fixture1, "r")).to.be.fulfilled;
+    const group=await expect(file.get("/mozaic_flight_2012030419144751_ascent")).to.be.fulfilled;
+    expect(group.inspect()).to.be.equal("[Group mozaic_flight_2012030419144751_ascent]");
+    const name=Object.keys(await group.getVariables())[0];
+    const variable=await expect(file.get(`/mozaic_flight_2012030419144751_ascent/${name}`)).to.be.fulfilled;
+    expect(variable.name).to.be.equal(name);
+    await expect(file.get("/UTC_time")).eventually.to.have.property("name","UTC_time");
+    await expect(file.get("/recNum")).eventually.to.be.deep.equal({recNum:74});
+    await expect(file.get("/no/such/path")).to.be.rejectedWith("Path /no/such/path not found");
+    await file.close();
+  });
+
+  it("should describe whole file", async function () {
+    const file=await expect(netcdf4.open(fixture1, "r")).to.be.fulfilled;
+    const description=await expect(file.describe()).to.be.fulfilled;
+    expect(description.format).to.be.equal("hdf5");
+    expect(description.root.dimensions).to.deep.equal({recNum:74});
+    expect(description.root.variables.UTC_time).to.include({type:"string"});
+    expect(description.root.variables.UTC_time.shape).to.deep.equal([74]);
+    expect(Object.keys(description.root.groups)).to.deep.equal(Object.keys(await file.root.getSubgroups()));
+    const json=await expect(file.describe({json:true})).to.be.fulfilled;
+    expect(JSON.parse(json)).to.deep.equal(description);
+    await file.close();
+    const file1=await expect(netcdf4.open(fixture, "r", undefined, {schema:false})).to.be.fulfilled;
+    await expect(file1.describe()).eventually.to.have.nested.property("root.variables.var1.shape").deep.equal([10000]);
+    await file1.close();
+  });
+
+  it("should open file from buffer", async function () {
+    const contents=readFileSync(fixture);
+    const file=await expect(netcdf4.openBuffer(contents)).to.be.fulfilled;
+    expect(file.format).to.be.equal("netcdf3");
+    const values=await file.root.variables.var1.readSlice(0, 4);
+    expect(Array.from(values)).to.deep.equal([420, 197, 391.5, 399]);
+    await expect(file.toBuffer()).eventually.to.be.equal(contents);
+    expect(file.closed).true;
+    await expect(netcdf4.openBuffer("not a buffer")).to.be.rejectedWith("Expecting a Buffer");
+  });
+
+  it("should create file in memory", async function () {
+    const file=await expect(netcdf4.createBuffer("classic")).to.be.fulfilled;
+    expect(file.defineMode).true;
+    await file.root.addDimension("x", 4);
+    const variable=await file.root.addVariable("v", "int", ["x"]);
+    await file.dataMode();
+    expect(file.defineMode).false;
+    await variable.writeSlice(0, 4, new Int32Array([1, 2, 3, 4]));
+    const contents=await expect(file.toBuffer()).to.be.fulfilled;
+    expect(contents.subarray(0, 3).toString()).to.be.equal("CDF");
+    const copy=await netcdf4.openBuffer(contents, {mode:"w"});
+    await expect(copy.root.variables.v.readSlice(0, 4)).eventually.to.deep.equal(new Int32Array([1, 2, 3, 4]));
+    await copy.close();
+  });
+
+  it("should create diskless file", async function () {
+    const dir=mkdtempSync(join(tmpdir(), "netcdf4-diskless-"));
+    try {
+      const scratch=join(dir, "scratch.nc");
+      const file=await expect(netcdf4.open(scratch, "c!", "classic", {diskless:true})).to.be.fulfilled;
+      await file.root.addDimension("x", 4);
+      await file.close();
+      expect(existsSync(scratch)).false;
+      const persisted=join(dir, "persisted.nc");
+      const kept=await expect(netcdf4.open(persisted, "c!", "classic", {diskless:true, persist:true})).to.be.fulfilled;
+      await kept.root.addDimension("x", 4);
+      await kept.close();
+      const reopened=await expect(netcdf4.open(persisted, "r", undefined, {mmap:true})).to.be.fulfilled;
+      expect(reopened.root.dimensions).to.deep.equal({x:4});
+      await reopened.close();
+      await expect(netcdf4.open(scratch, "c!", "classic", {persist:true})).to.be.rejectedWith("persist requires diskless or mmap");
+      await expect(netcdf4.open(scratch, "c!", "netcdf4", {mmap:true})).to.be.rejectedWith("classic files only");
+    } finally {
+      rmSync(dir, {recursive:true, force:true});
+    }
+  });
+
+  it("should read netCDF-3 file with native reader", async function () {
+    const before=netcdf4.stats().nativeReader.reads;
+    const file=await expect(netcdf4.open(fixture, "r", undefined, {nativeReader:true})).to.be.fulfilled;
+    const variable=file.root.variables.var1;
+    expect(Array.from(await variable.readSlice(0, 4))).to.deep.equal([420, 197, 391.5, 399]);
+    expect(Array.from(await variable.readStridedSlice(0, 2, 2))).to.deep.equal([420, 391.5]);
+    await expect(variable.read(1)).eventually.to.be.equal(197);
+    await expect(variable.readSlice(9998, 4)).to.be.rejectedWith("Start+count exceeds dimension bound");
+    expect(netcdf4.stats().nativeReader.reads).to.be.equal(before+4);
+    await file.close();
+  });
+
+  it("should keep copying native reads apart from views", async function () {
+    const dir=mkdtempSync(join(tmpdir(), "netcdf4-view-"));
+    try {
+      const source=await netcdf4.createBuffer("classic");
+      await source.root.addDimension("x", 4);
+      const variable=await source.root.addVariable("v", "byte", ["x"]);
+      await source.dataMode();
+      await variable.writeSlice(0, 4, new Int8Array([1, 2, 3, 4]));
+      const path=join(dir, "view.nc");
+      writeFileSync(path, await source.toBuffer());
+      const before=netcdf4.stats().nativeReader.views;
+      const file=await expect(netcdf4.open(path, "r", undefined, {nativeReader:"view"})).to.be.fulfilled;
+      const view=await file.root.variables.v.readSlice(0, 4);
+      expect(netcdf4.stats().nativeReader.views).to.be.equal(before+1);
+      view[1]=99;
+      await expect(file.root.variables.v.read(1)).eventually.to.be.equal(2);
+      await file.close();
+    } finally {
+      rmSync(dir, {recursive:true, force:true});
+    }
+  });
+
+  it("should open file from metadata index", async function () {
+    const dir=mkdtempSync(join(tmpdir(), "netcdf4-index-"));
+    try {
+      const before=netcdf4.stats().metadataIndex;
+      const file=await expect(netcdf4.open(fixture1, "r", undefined, {index:dir})).to.be.fulfilled;
+      const description=await file.describe();
+      await file.close();
+      const indexed=await expect(netcdf4.open(fixture1, "r", undefined, {index:dir})).to.be.fulfilled;
+      expect(netcdf4.stats().metadataIndex.hits).to.be.equal(before.hits+1);
+      expect(await indexed.describe()).to.deep.equal(description);
+      expect(indexed.root.variables.UTC_time.shape).to.deep.equal([74]);
+      expect(netcdf4.stats().metadataIndex.deferredOpens).to.be.equal(before.deferredOpens);
+      const subgroup=Object.values(indexed.root.subgroups)[0];
+      expect(Object.keys(await subgroup.getVariables())).to.deep.equal(Object.keys(subgroup.variables));
+      expect(netcdf4.stats().metadataIndex.deferredOpens).to.be.equal(before.deferredOpens+1);
+      await indexed.close();
+    } finally {
+      rmSync(dir, {recursive:true, force:true});
+    }
+  });
 });
@@ -145,6 +145,68 @@ describe("Group", function () {
     await expect(file.root.getVariables()).eventually.to.have.property("UTC_time");
   });
 
+  it("should read schema synchronously", async function () {
+    const variables = await file.root.getVariables();
+    expect(Object.keys(file.root.variables)).to.deep.equal(Object.keys(variables));
+    expect(file.root.dimensions).to.deep.equal(await file.root.getDimensions());
+    expect(Object.keys(file.root.subgroups)).to.deep.equal(Object.keys(await file.root.getSubgroups()));
+    expect(file.root.attributes).to.deep.equal(await file.root.getAttributes(false));
+    const variable = file.root.variables.UTC_time;
+    expect(variable.shape).to.deep.equal(Object.values(await variable.getDimensions()));
+    expect(variable.dimensions).to.deep.equal(await variable.getDimensions());
+    expect(variable.attributes).to.deep.equal(await variable.getAttributes(false));
+  });
+
+  it("should update schema after definition changes", async function () {
+    await file.root.addDimension("new_dim",3);
+    expect(file.root.dimensions).to.have.property("new_dim",3);
+    const variable = await file.root.addVariable("test_variable","int",["new_dim"]);
+    expect(variable.shape).to.deep.equal([3]);
+    await variable.addAttribute("units","char","m");
+    expect(variable.attributes).to.deep.equal({units:"m"});
+    await file.root.addSubgroup("new_group");
+    expect(file.root.subgroups).to.have.property("new_group");
+    await file.root.addDimension("time","unlimited");
+    const series = await file.root.addVariable("series","int",["time"]);
+    expect(series.shape).to.deep.equal([0]);
+    await series.writeSlice(0,2,new Int32Array([1,2]));
+    expect(series.shape).to.deep.equal([2]);
+    expect(file.root.dimensions).to.have.property("time",2);
+    const nested = await file.root.addSubgroup("nested");
+    const inner = await nested.addVariable("inner","int",["time"]);
+    await inner.writeSlice(0,3,new Int32Array([1,2,3]));
+    expect(inner.shape).to.deep.equal([3]);
+    expect(file.root.dimensions).to.have.property("time",3);
+  });
+
+  it("should open file without schema", async function () {
+    const file1 = await netcdf4.open(file.name, "r", undefined, {schema:false});
+    expect(() => file1.root.variables).to.throw("Schema is not loaded");
+    await expect(file1.root.getVariables()).eventually.to.have.property("UTC_time");
+    await file1.close();
+  });
+
+  it("should read same hyperslab of many variables", async function () {
+    const file1 = await newFile(fixture1);
+    const values = await expect(file1.root.readVariables({names:["var1"], start:[0], count:[4]})).to.be.fulfilled;
+    expect(Object.keys(values)).to.deep.equal(["var1"]);
+    expect(Array.from(values.var1)).to.deep.equal([420, 197, 391.5, 399]);
+    await expect(file1.root.readVariables({names:["var1"], start:[0,0], count:[4,1]})).to.be.rejectedWith("dimension");
+    const first = await file.root.addVariable("first","int",["recNum"]);
+    const second = await file.root.addVariable("second","double",["recNum"]);
+    await first.writeSlice(0,4,new Int32Array([1,2,3,4]));
+    await second.writeSlice(0,4,new Float64Array([0.5,1.5,2.5,3.5]));
+    const both = await expect(file.root.readVariables({names:["first","second"], start:[1], count:[3]})).to.be.fulfilled;
+    expect(both.first).to.deep.equal(new Int32Array([2,3,4]));
+    expect(both.second).to.deep.equal(new Float64Array([1.5,2.5,3.5]));
+    // Values read before failing variable are returned to buffer pool
+    const wrong = {names:["first","second","missing"], start:[1], count:[3]};
+    await expect(file.root.readVariables(wrong)).to.be.rejected;
+    const before = netcdf4.stats().bufferPool;
+    await expect(file.root.readVariables(wrong)).to.be.rejected;
+    expect(netcdf4.stats().bufferPool.misses).to.be.equal(before.misses);
+  });
+
   it("should create new variable ", async function () {
     await expect(file.root.getVariables()).eventually.to.not.have.property("test_variable");
     var newVar=await expect(file.root.addVariable('test_variable','byte',['recNum'])).be.fulfilled;
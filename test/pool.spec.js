@@ -0,0 +1,78 @@
+const chai = require("chai");
+const expect = chai.expect;
+const chaiAsPromised = require('chai-as-promised');
+chai.use(chaiAsPromised);
+
+const netcdf4 = require("..");
+const { join } = require("path");
+const { existsSync, readdirSync } = require("fs");
+
+const fixture = join(__dirname, "testrh.nc");
+const fixture1 = join(__dirname, "test_hgroups.nc");
+
+describe("ReaderPool", function () {
+  let pool;
+
+  beforeEach(function () {
+    pool = new netcdf4.ReaderPool({processes: 2});
+  });
+
+  afterEach(async function () {
+    await pool.close();
+  });
+
+  it("should read a slice through helper processes", async function () {
+    const reads=[];
+    for (let i=0;i<8;i++) {
+      reads.push(pool.readSlice(fixture, "var1", [0], [4]));
+    }
+    const results=await Promise.all(reads);
+    results.forEach(res=>{
+      expect(res).to.be.instanceOf(Float32Array);
+      expect(Array.from(res)).to.deep.equal([420, 197, 391.5, 399]);
+    });
+  });
+
+  it("should reject unknown variable", async function () {
+    await expect(pool.readSlice(fixture, "/nothing", [0], [4])).to.be.rejectedWith("not found");
+  });
+
+  it("should reject not supported variable type", async function () {
+    await expect(pool.readSlice(fixture1, "/UTC_time", [0], [4])).to.be.rejectedWith("not supported");
+  });
+
+  it("should remove shared memory of failed reads", async function () {
+    if (!existsSync("/dev/shm")) {
+      this.skip();
+    }
+    const segments=()=>readdirSync("/dev/shm").filter(name=>name.startsWith("nc4a.")).length;
+    await expect(pool.readSlice(fixture, "var1", [0], [4])).to.be.fulfilled;
+    const before=segments();
+    await expect(pool.readSlice(fixture, "var1", [9998], [4])).to.be.rejectedWith("exceeds dimension bound");
+    expect(segments()).to.be.equal(before);
+  });
+
+  it("should remove shared memory of crashed helpers", async function () {
+    if (!existsSync("/dev/shm")) {
+      this.skip();
+    }
+    const read=pool.readSlice(fixture, "var1", [0], [4]);
+    // Stands for segment helper created before it crashed
+    const name=pool.segmentPrefix+pool.lastId;
+    netcdf4.createShared(16, name);
+    expect(existsSync(join("/dev/shm", name))).to.be.true;
+    pool.workers.forEach(worker=>worker.process.kill("SIGKILL"));
+    await expect(read).to.be.rejectedWith("Reader process exited");
+    expect(existsSync(join("/dev/shm", name))).to.be.false;
+  });
+
+  it("should not attach shared memory beyond its size", function () {
+    const segment=netcdf4.createShared(16);
+    try {
+      expect(()=>netcdf4.attachShared(segment.name, 1<<20)).to.throw();
+      expect(netcdf4.attachShared(segment.name, 16).byteLength).to.be.equal(16);
+    } finally {
+      netcdf4.unlinkShared(segment.name);
+    }
+  });
+});
@@ -0,0 +1,46 @@
+const chai = require("chai");
+const expect = chai.expect;
+const chaiAsPromised = require('chai-as-promised');
+chai.use(chaiAsPromised);
+
+const netcdf4 = require("..");
+const { join } = require("path");
+
+const fixture = join(__dirname, "testrh.nc");
+const fixture1 = join(__dirname, "test_hgroups.nc");
+const missing = join(__dirname, "missing.nc");
+
+async function collect(iterator) {
+  const result = [];
+  for await (const summary of iterator) {
+    result.push(summary);
+  }
+  return result;
+}
+
+describe("scan", function () {
+
+  it('should summarize files and report errors', async function () {
+    const summaries = await collect(netcdf4.scan([fixture, fixture1, missing], {batchSize: 2}));
+    expect(summaries).to.have.length(3);
+    const byPath = Object.fromEntries(summaries.map(summary => [summary.path, summary]));
+    expect(byPath[fixture].format).to.be.equal("netcdf3");
+    expect(byPath[fixture].variables.var1.shape).to.deep.equal([10000]);
+    expect(byPath[fixture].dimensions).to.have.property("dim1");
+    expect(byPath[fixture1].format).to.be.equal("hdf5");
+    expect(byPath[fixture1].variables).to.have.property("UTC_time");
+    expect(byPath[missing]).to.have.property("error");
+  });
+
+  it('should detect format by magic bytes', async function () {
+    const summaries = await collect(netcdf4.scan([fixture, fixture1, missing], {sniff: true}));
+    expect(summaries.map(summary => summary.format)).to.deep.equal(["netcdf3", "hdf5", undefined]);
+    expect(summaries[0]).not.to.have.property("variables");
+    expect(summaries[2]).to.have.property("error");
+  });
+
+  it('should reject unknown fields', async function () {
+    await expect(collect(netcdf4.scan([fixture], {fields: ["bogus"]}))).to.be.rejectedWith("Unknown field bogus");
+  });
+
+});
@@ -9,6 +9,7 @@ var type_detect = require('type-detect');
 
 const netcdf4 = require("..");
 const { join } = require("path");
+const { readFileSync, writeFileSync } = require("fs");
 
 const fixture = join(__dirname, "testrh.nc");
 const fixture1 = join(__dirname, "test_hgroups.nc");
@@ -126,6 +127,20 @@ describe("Variable", function () {
 //    console.log(res);
   });
 
+  it("should keep order of concurrent operations on one file",async function () {
+    const variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
+    const reads=[];
+    for (let i=0;i<32;i++) {
+      reads.push(variable.readSlice(0, 4));
+    }
+    const write=variable.write(0,42);
+    const after=variable.read(0);
+    const results=await Promise.all(reads);
+    results.forEach(res=>expect(Array.from(res)).to.deep.equal([420, 197, 391.5, 399]));
+    await expect(write).to.be.fulfilled;
+    await expect(after).eventually.to.be.equal(42);
+  });
+
   it("should read a strided slice",async function () {
     let variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
     var res = await expect(variable.readStridedSlice(0, 2, 2)).to.be.fulfilled;
@@ -133,6 +148,150 @@ describe("Variable", function () {
     expect(results).to.deep.equal([420, 391.5]);
   });
 
+  it("should read a slice into existing array",async function () {
+    let variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
+    const target=new Float32Array(6);
+    const res = await expect(variable.readSliceInto(target, 1, 0, 4)).to.be.fulfilled;
+    expect(res).to.be.equal(target);
+    expect(Array.from(target)).to.deep.equal([0, 420, 197, 391.5, 399, 0]);
+    await expect(variable.readStridedSliceInto(target, 4, 0, 2, 2)).to.be.fulfilled;
+    expect(Array.from(target)).to.deep.equal([0, 420, 197, 391.5, 420, 391.5]);
+    await expect(variable.readSliceInto(target, 4, 0, 4)).to.be.rejectedWith("too small");
+    await expect(variable.readSliceInto(new Float64Array(4), 0, 0, 4)).to.be.rejectedWith("does not match");
+  });
+
+  it("should coalesce concurrent reads of neighbouring slices",async function () {
+    const variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
+    const before=netcdf4.stats().coalescer.merged;
+    const blocker=variable.readSlice(0, 1000);
+    const tiles=[variable.readSlice(0, 2), variable.readSlice(2, 2), variable.readSlice(1, 2), variable.read(3)];
+    const wrong=variable.readSlice(9999, 2);
+    await blocker;
+    const results=await Promise.all(tiles);
+    expect(Array.from(results[0])).to.deep.equal([420, 197]);
+    expect(Array.from(results[1])).to.deep.equal([391.5, 399]);
+    expect(Array.from(results[2])).to.deep.equal([197, 391.5]);
+    expect(results[3]).to.be.equal(399);
+    await expect(wrong).to.be.rejected;
+    expect(netcdf4.stats().coalescer.merged).to.be.above(before);
+  });
+
+  it("should share identical reads in flight",async function () {
+    const variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
+    const before=netcdf4.stats().singleFlight.hits;
+    const first=variable.readSlice(0, 4);
+    const second=variable.readSlice(0, 4);
+    const write=variable.write(0, 42);
+    const third=variable.readSlice(0, 4);
+    const [r1, r2]=await Promise.all([first, second]);
+    expect(Array.from(r2)).to.deep.equal([420, 197, 391.5, 399]);
+    expect(r2).to.not.equal(r1);
+    await write;
+    expect(Array.from(await third)).to.deep.equal([42, 197, 391.5, 399]);
+    expect(netcdf4.stats().singleFlight.hits).to.be.equal(before+1);
+    netcdf4.configure({singleFlightShared:true});
+    try {
+      const [s1, s2]=await Promise.all([variable.readSlice(0, 4), variable.readSlice(0, 4)]);
+      expect(s2).to.equal(s1);
+    } finally {
+      netcdf4.configure({singleFlightShared:false});
+    }
+  });
+
+  it("should cache read results when enabled",async function () {
+    const variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
+    netcdf4.configure({cacheSize:1024*1024});
+    try {
+      const before=netcdf4.stats().cache;
+      expect(Array.from(await variable.readSlice(0, 4))).to.deep.equal([420, 197, 391.5, 399]);
+      expect(Array.from(await variable.readSlice(0, 4))).to.deep.equal([420, 197, 391.5, 399]);
+      let after=netcdf4.stats().cache;
+      expect(after.hits).to.be.equal(before.hits+1);
+      expect(after.entries).to.be.equal(before.entries+1);
+      await variable.write(0, 42);
+      expect(Array.from(await variable.readSlice(0, 4))).to.deep.equal([42, 197, 391.5, 399]);
+      after=netcdf4.stats().cache;
+      expect(after.hits).to.be.equal(before.hits+1);
+      netcdf4.configure({cacheSize:16});
+      expect(netcdf4.stats().cache.evictions).to.be.above(before.evictions);
+    } finally {
+      netcdf4.configure({cacheSize:0});
+    }
+  });
+
+  it("should not serve cached results of rewritten file",async function () {
+    const variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
+    await variable.write(0, 42);
+    const changed = readFileSync(fileold.name);
+    await fileold.close();
+    const copy = await newFile(fixture);
+    const path = copy.name;
+    await copy.close();
+    netcdf4.configure({cacheSize:1024*1024});
+    try {
+      let file = await netcdf4.open(path, "r");
+      expect(Array.from(await file.root.variables.var1.readSlice(0, 4))).to.deep.equal([420, 197, 391.5, 399]);
+      await file.close();
+      // Same size, usually within the same second
+      writeFileSync(path, changed);
+      file = await netcdf4.open(path, "r");
+      expect(Array.from(await file.root.variables.var1.readSlice(0, 4))).to.deep.equal([42, 197, 391.5, 399]);
+      await file.close();
+    } finally {
+      netcdf4.configure({cacheSize:0});
+    }
+  });
+
+  it("should read many slices at once",async function () {
+    const variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
+    const slices=[{start:[0],count:[2]},{start:[2],count:[2]},{start:[0],count:[2],stride:[2]}];
+    const res = await expect(variable.readSlices(slices)).to.be.fulfilled;
+    expect(res.map(v=>Array.from(v))).to.deep.equal([[420, 197], [391.5, 399], [420, 391.5]]);
+    const packed = await expect(variable.readSlices(slices,{packed:true})).to.be.fulfilled;
+    expect(Array.from(packed.data)).to.deep.equal([420, 197, 391.5, 399, 420, 391.5]);
+    expect(packed.offsets).to.deep.equal([0, 2, 4]);
+    await expect(variable.readSlices([{start:[0]}])).to.be.rejectedWith("Wrong hyperslab at index 0");
+    const wrong=[{start:[0],count:[100]},{start:[9998],count:[4]}];
+    await expect(variable.readSlices(wrong)).to.be.rejectedWith("exceeds dimension bound");
+    const before=netcdf4.stats().bufferPool;
+    await expect(variable.readSlices(wrong)).to.be.rejectedWith("exceeds dimension bound");
+    expect(netcdf4.stats().bufferPool.misses).to.be.equal(before.misses);
+  });
+
+  it("should get and set chunk cache (hdf5)",async function () {
+    const variable = await expect(filenew.root.getVariable("UTC_time")).to.be.fulfilled;
+    await expect(variable.setChunkCache({size:1048576,nelems:1009,preemption:0.5})).to.be.fulfilled;
+    await expect(variable.getChunkCache()).eventually.to.deep.almost.equal({size:1048576,nelems:1009,preemption:0.5,adaptive:false});
+    await expect(variable.setChunkCache({preemption:0.25})).to.be.fulfilled;
+    await expect(variable.getChunkCache()).eventually.to.deep.almost.equal({size:1048576,nelems:1009,preemption:0.25,adaptive:false});
+    await expect(variable.setChunkCache({adaptive:true,maxSize:4194304})).to.be.fulfilled;
+    await expect(variable.read(0)).eventually.to.be.equal('2012-03-04 03:54:19');
+    await expect(variable.getChunkCache()).eventually.to.have.property("adaptive",true);
+    await expect(variable.setChunkCache({preemption:2})).to.be.rejected;
+    await filenew.root.addDimension("cx", 1000);
+    const chunked = await filenew.root.addVariable("chunked","double",["cx"]);
+    await chunked.setChunked("chunked",new Uint32Array([10]));
+    await chunked.writeSlice(0, 1000, new Float64Array(1000).fill(1));
+    // Each access builds new Variable object, adaptive mode is kept by variable
+    await expect(filenew.root.variables.chunked.setChunkCache({adaptive:true,maxSize:4194304})).to.be.fulfilled;
+    const before = await filenew.root.variables.chunked.getChunkCache();
+    await filenew.root.variables.chunked.readSlice(0, 1000);
+    const after = await filenew.root.variables.chunked.getChunkCache();
+    expect(after.adaptive).to.be.true;
+    expect(after.size).to.be.above(before.size);
+    await expect(filenew.root.variables.chunked.setChunkCache({adaptive:false})).to.be.fulfilled;
+    await expect(chunked.getChunkCache()).eventually.to.have.property("adaptive",false);
+  });
+
+  it("should open file with chunk cache options",async function () {
+    const file = await expect(netcdf4.open(fixture1,'r','netcdf4',{chunkCache:{size:2097152,preemption:0.5}})).to.be.fulfilled;
+    const variable = await expect(file.root.getVariable("UTC_time")).to.be.fulfilled;
+    await expect(variable.getChunkCache()).eventually.to.deep.include({size:2097152,preemption:0.5});
+    await expect(variable.read(0)).eventually.to.be.equal('2012-03-04 03:54:19');
+    await file.close();
+    await expect(netcdf4.open(fixture1,'r','netcdf4',{chunkCache:{size:-1}})).to.be.rejected;
+  });
+
   it("should write a slice of existing",async function () {
     let variable = await expect(fileold.root.getVariable("var1")).to.be.fulfilled;
     const varr=new Float32Array([10,10.5,20,20.5])